@@ -0,0 +1,561 @@
+﻿#include "sort.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+
+/**
+* @brief ソートアルゴリズムのベンチマーク
+* @detail 要素型・入力分布・要素数の組み合わせ毎に各アルゴリズムの実行時間を測り、結果をJSONで出力する
+*/
+namespace benchmark {
+
+	/**
+	* @brief 64バイトのレコード
+	*/
+	struct record64 {
+		std::uint64_t key;
+		std::uint64_t payload[7];
+
+		friend bool operator<(const record64& lhs, const record64& rhs) noexcept {
+			return lhs.key < rhs.key;
+		}
+
+		friend bool operator==(const record64& lhs, const record64& rhs) noexcept {
+			return lhs.key == rhs.key && std::equal(std::begin(lhs.payload), std::end(lhs.payload), std::begin(rhs.payload));
+		}
+	};
+
+	static_assert(sizeof(record64) == 64);
+
+	/**
+	* @brief 要素型毎の名前とキーからの生成
+	*/
+	template<typename T>
+	struct element;
+
+	template<>
+	struct element<int> {
+		static constexpr const char* name = "int";
+		static auto make(std::uint64_t key) -> int { return int(key); }
+	};
+
+	template<>
+	struct element<std::int64_t> {
+		static constexpr const char* name = "int64";
+		static auto make(std::uint64_t key) -> std::int64_t { return std::int64_t(key); }
+	};
+
+	template<>
+	struct element<double> {
+		static constexpr const char* name = "double";
+		static auto make(std::uint64_t key) -> double { return double(key) * 0.5; }
+	};
+
+	template<>
+	struct element<record64> {
+		static constexpr const char* name = "record64";
+		static auto make(std::uint64_t key) -> record64 { return { key, { key, key, key, key, key, key, key } }; }
+	};
+
+	template<>
+	struct element<std::string> {
+		static constexpr const char* name = "string";
+		//共通の接頭辞を持つ文字列（比較ソートは毎回接頭辞を比べ直す）
+		static auto make(std::uint64_t key) -> std::string { return "/var/data/item/" + std::to_string(key); }
+	};
+
+	/**
+	* @brief 入力分布
+	*/
+	enum class distribution {
+		random,
+		sorted,
+		reversed,
+		organ_pipe,
+		sawtooth,
+		few_unique,
+		mostly_sorted,
+	};
+
+	inline constexpr distribution all_distributions[] = {
+		distribution::random,
+		distribution::sorted,
+		distribution::reversed,
+		distribution::organ_pipe,
+		distribution::sawtooth,
+		distribution::few_unique,
+		distribution::mostly_sorted,
+	};
+
+	auto to_string(distribution dist) -> const char* {
+		switch (dist) {
+		case distribution::random: return "random";
+		case distribution::sorted: return "sorted";
+		case distribution::reversed: return "reversed";
+		case distribution::organ_pipe: return "organ_pipe";
+		case distribution::sawtooth: return "sawtooth";
+		case distribution::few_unique: return "few_unique";
+		case distribution::mostly_sorted: return "mostly_sorted";
+		}
+		return "";
+	}
+
+	/**
+	* @brief 分布に従うキー列を生成する（キーは2^31未満）
+	*/
+	auto generate_keys(distribution dist, std::size_t size, std::uint64_t seed) -> std::vector<std::uint64_t> {
+		std::mt19937_64 rand{ seed };
+		std::vector<std::uint64_t> keys(size);
+
+		switch (dist) {
+		case distribution::random:
+			for (auto& key : keys) key = rand() >> 33;
+			break;
+		case distribution::sorted:
+			std::iota(keys.begin(), keys.end(), std::uint64_t(0));
+			break;
+		case distribution::reversed:
+			for (std::size_t i = 0; i < size; ++i) keys[i] = size - i;
+			break;
+		case distribution::organ_pipe:
+			//前半は昇順、後半は降順
+			for (std::size_t i = 0; i < size; ++i) keys[i] = (i < size / 2) ? i : size - i;
+			break;
+		case distribution::sawtooth:
+			//昇順の列が8回繰り返す
+			for (std::size_t i = 0; i < size; ++i) keys[i] = i % (size / 8 + 1);
+			break;
+		case distribution::few_unique:
+			for (auto& key : keys) key = rand() % 16;
+			break;
+		case distribution::mostly_sorted:
+			//昇順の列の1%を入れ替える
+			std::iota(keys.begin(), keys.end(), std::uint64_t(0));
+			if (1 < size) {
+				for (std::size_t i = 0; i < size / 100 + 1; ++i) std::swap(keys[rand() % size], keys[rand() % size]);
+			}
+			break;
+		}
+
+		return keys;
+	}
+
+	/**
+	* @brief 計測するアルゴリズムを列挙する
+	* @detail f(名前, 要素数の2乗に比例するか, ソートする関数)の形で呼び出す
+	* @detail ソートする関数は(begin, end, 比較ファンクタ)を受け取る。比較回数を数えるファンクタを受け取れないものは比較ファンクタの型を固定する
+	*/
+	template<typename T, typename F>
+	void for_each_algorithm(F&& f) {
+		using iterator = typename std::vector<T>::iterator;
+		using default_compare = std::less<T>;
+
+		f("std::sort", false, [](iterator begin, iterator end, auto comp) { std::sort(begin, end, comp); });
+		f("std::stable_sort", false, [](iterator begin, iterator end, auto comp) { std::stable_sort(begin, end, comp); });
+
+		f("bubble_sort", true, [](iterator begin, iterator end, auto comp) { sort_collection::bubble_sort::sort(begin, end, comp); });
+		f("shaker_sort", true, [](iterator begin, iterator end, auto comp) { sort_collection::shaker_sort::sort(begin, end, comp); });
+		f("comb_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::comb_sort::sort(begin, end, comp); });
+		f("gnome_sort", true, [](iterator begin, iterator end, auto comp) { sort_collection::gnome_sort::sort(begin, end, comp); });
+		f("selection_sort", true, [](iterator begin, iterator end, auto comp) { sort_collection::selection_sort::sort(begin, end, comp); });
+		f("insertion_sort", true, [](iterator begin, iterator end, auto comp) { sort_collection::insertion_sort::sort(begin, end, comp); });
+		f("shell_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::shell_sort::sort(begin, end, comp); });
+		f("shell_sort<knuth>", false, [](iterator begin, iterator end, auto comp) { sort_collection::basic_shell_sort<sort_collection::gap_sequence::knuth>::sort(begin, end, comp); });
+		f("shell_sort<tokuda>", false, [](iterator begin, iterator end, auto comp) { sort_collection::basic_shell_sort<sort_collection::gap_sequence::tokuda>::sort(begin, end, comp); });
+		f("shell_sort<sedgewick>", false, [](iterator begin, iterator end, auto comp) { sort_collection::basic_shell_sort<sort_collection::gap_sequence::sedgewick>::sort(begin, end, comp); });
+		f("shell_sort<pratt>", false, [](iterator begin, iterator end, auto comp) { sort_collection::basic_shell_sort<sort_collection::gap_sequence::pratt>::sort(begin, end, comp); });
+		f("marge_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::marge_sort::sort(begin, end, comp); });
+		f("block_merge_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::block_merge_sort::sort(begin, end, comp); });
+		f("tim_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::tim_sort::sort(begin, end, comp); });
+		f("incremental_sort(1ms)", false, [](iterator begin, iterator end, auto comp) {
+			//1msずつのスライスに分けた場合の合計（marge_sortとの差がスライスに分ける余分な仕事）
+			sort_collection::incremental_sort sorter(begin, end, comp);
+			while (sorter.step_for(std::chrono::milliseconds(1)) == false) {}
+		});
+		f("pdq_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::pdq_sort::sort(begin, end, comp); });
+		f("three_way_quick_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::three_way_quick_sort::sort(begin, end, comp); });
+
+		//共有のスレッドプールを使う並列版
+		f("marge_sort(par)", false, [](iterator begin, iterator end, auto comp) { sort_collection::marge_sort::sort(std::execution::par, begin, end, comp); });
+		f("sample_sort(par)", false, [](iterator begin, iterator end, auto comp) { sort_collection::sample_sort<>::sort(std::execution::par, begin, end, comp); });
+
+		f("auto_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::auto_sort::sort(begin, end, comp); });
+		f("stable_auto_sort", false, [](iterator begin, iterator end, auto comp) { sort_collection::stable_auto_sort::sort(begin, end, comp); });
+
+		//基数ソートはキーを射影する（文字列は文字列のソート）
+		if constexpr (std::is_arithmetic_v<T>) {
+			f("radix_sort", false, [](iterator begin, iterator end, default_compare c) { sort_collection::radix_sort::sort(begin, end, c); });
+			f("radix_sort(par)", false, [](iterator begin, iterator end, default_compare c) { sort_collection::radix_sort::sort(std::execution::par, begin, end, c); });
+			f("american_flag_sort", false, [](iterator begin, iterator end, default_compare c) { sort_collection::american_flag_sort::sort(begin, end, c); });
+			if constexpr (std::is_integral_v<T>) {
+				f("counting_sort", false, [](iterator begin, iterator end, default_compare c) { sort_collection::counting_sort::sort(begin, end, c); });
+			}
+		}
+		else if constexpr (std::is_same_v<T, std::string>) {
+			f("string_sort", false, [](iterator begin, iterator end, default_compare c) { sort_collection::string_sort::sort(begin, end, c); });
+		}
+		else {
+			auto key = [](const T& value) { return value.key; };
+			f("radix_sort", false, [key](iterator begin, iterator end, default_compare) { sort_collection::radix_sort::sort(begin, end, std::less<>{}, key); });
+			f("radix_sort(par)", false, [key](iterator begin, iterator end, default_compare) { sort_collection::radix_sort::sort(std::execution::par, begin, end, std::less<>{}, key); });
+			f("american_flag_sort", false, [key](iterator begin, iterator end, default_compare) { sort_collection::american_flag_sort::sort(begin, end, std::less<>{}, key); });
+			f("counting_sort", false, [key](iterator begin, iterator end, default_compare) { sort_collection::counting_sort::sort(begin, end, std::less<>{}, key); });
+		}
+	}
+
+	/**
+	* @brief コマンドライン引数
+	*/
+	struct options {
+		std::vector<std::size_t> sizes;
+		std::size_t min_size = 16;
+		std::size_t max_size = std::size_t(1) << 20;
+		std::size_t step = 16;
+		std::size_t quadratic_limit = std::size_t(1) << 14;
+		std::size_t repeat = 5;
+		std::vector<std::string> algorithms;
+		std::vector<std::string> distributions;
+		std::vector<std::string> types;
+		std::string output = "-";
+		std::uint64_t seed = 1;
+		bool count_comparisons = false;
+	};
+
+	auto split(const std::string& list) -> std::vector<std::string> {
+		std::vector<std::string> items;
+		std::istringstream stream{ list };
+		for (std::string item; std::getline(stream, item, ',');) {
+			if (item.empty() == false) items.push_back(item);
+		}
+		return items;
+	}
+
+	/**
+	* @brief 絞り込みの指定が無いか、指定に含まれるか
+	*/
+	auto selected(const std::vector<std::string>& filter, const std::string& name) -> bool {
+		return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+	}
+
+	void print_usage() {
+		std::cerr <<
+			"usage: sort_benchmark [options]\n"
+			"  --sizes N,N,...          sizes to measure (overrides --min-size/--max-size/--step)\n"
+			"  --min-size N             smallest size (default 16)\n"
+			"  --max-size N             largest size (default 1048576, up to 100000000)\n"
+			"  --step N                 size multiplier (default 16)\n"
+			"  --quadratic-limit N      largest size for O(N^2) algorithms (default 16384)\n"
+			"  --repeat N               samples per measurement (default 5)\n"
+			"  --algorithms a,b,...     algorithms to run (default all)\n"
+			"  --distributions a,b,...  random,sorted,reversed,organ_pipe,sawtooth,few_unique,mostly_sorted\n"
+			"  --types a,b,...          int,int64,double,record64,string\n"
+			"  --seed N                 seed of the input generator (default 1)\n"
+			"  --count-comparisons      also count the comparisons of one extra run\n"
+			"  --output FILE            JSON output file (default stdout)\n";
+	}
+
+	auto parse_options(int argc, char* argv[]) -> options {
+		options opt{};
+
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+
+			if (arg == "--help" || arg == "-h") {
+				print_usage();
+				std::exit(0);
+			}
+			if (arg == "--count-comparisons") {
+				opt.count_comparisons = true;
+				continue;
+			}
+			if (i + 1 == argc) {
+				std::cerr << "missing value for " << arg << "\n";
+				std::exit(2);
+			}
+
+			const std::string value = argv[++i];
+			if (arg == "--sizes") {
+				for (auto& item : split(value)) opt.sizes.push_back(std::stoull(item));
+			}
+			else if (arg == "--min-size") opt.min_size = std::stoull(value);
+			else if (arg == "--max-size") opt.max_size = std::stoull(value);
+			else if (arg == "--step") opt.step = std::max<std::size_t>(2, std::stoull(value));
+			else if (arg == "--quadratic-limit") opt.quadratic_limit = std::stoull(value);
+			else if (arg == "--repeat") opt.repeat = std::max<std::size_t>(1, std::stoull(value));
+			else if (arg == "--algorithms") opt.algorithms = split(value);
+			else if (arg == "--distributions") opt.distributions = split(value);
+			else if (arg == "--types") opt.types = split(value);
+			else if (arg == "--seed") opt.seed = std::stoull(value);
+			else if (arg == "--output") opt.output = value;
+			else {
+				std::cerr << "unknown option " << arg << "\n";
+				print_usage();
+				std::exit(2);
+			}
+		}
+
+		if (opt.sizes.empty()) {
+			for (auto size = opt.min_size; size <= opt.max_size; size *= opt.step) {
+				opt.sizes.push_back(size);
+				if (opt.max_size / opt.step < size) break;
+			}
+			if (opt.sizes.empty() || opt.sizes.back() != opt.max_size) opt.sizes.push_back(opt.max_size);
+		}
+
+		return opt;
+	}
+
+	/**
+	* @brief JSON文字列としてエスケープする
+	*/
+	auto quote(const std::string& str) -> std::string {
+		std::string result = "\"";
+		for (auto c : str) {
+			if (c == '"' || c == '\\') result += '\\';
+			result += c;
+		}
+		return result + "\"";
+	}
+
+	/**
+	* @brief 1つの計測結果
+	*/
+	struct result {
+		std::string algorithm;
+		std::string type;
+		std::string distribution;
+		std::size_t size;
+		double min_ns;
+		double median_ns;
+		double mean_ns;
+		bool verified;
+		//比較回数（数えなかった時や比較ファンクタを使わないアルゴリズムでは無し）
+		std::optional<std::uint64_t> comparisons;
+	};
+
+	/**
+	* @brief 結果を逐次書き出す
+	*/
+	class json_writer {
+	public:
+
+		json_writer(std::ostream& out, const options& opt) : m_out{ out } {
+			const char* simd = "scalar";
+#if defined(SORT_COLLECTION_SIMD_X86)
+			switch (sort_collection::detail::simd::current_instruction_set()) {
+			case sort_collection::detail::simd::instruction_set::avx2: simd = "avx2"; break;
+			case sort_collection::detail::simd::instruction_set::sse41: simd = "sse4.1"; break;
+			default: break;
+			}
+#endif
+
+#if defined(SORT_COLLECTION_DISABLE_BRANCHLESS)
+			const bool branchless = false;
+#else
+			const bool branchless = true;
+#endif
+
+#if defined(__clang__)
+			const std::string compiler = "Clang " __clang_version__;
+#elif defined(__GNUC__)
+			const std::string compiler = "GCC " __VERSION__;
+#elif defined(_MSC_VER)
+			const std::string compiler = "MSVC " + std::to_string(_MSC_VER);
+#else
+			const std::string compiler = "unknown";
+#endif
+
+			m_out << "{\n"
+				<< "  \"context\": {\n"
+				<< "    \"compiler\": " << quote(compiler) << ",\n"
+				<< "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+				<< "    \"simd\": " << quote(simd) << ",\n"
+				<< "    \"branchless_compare_and_swap\": " << (branchless ? "true" : "false") << ",\n"
+				<< "    \"repeat\": " << opt.repeat << ",\n"
+				<< "    \"seed\": " << opt.seed << "\n"
+				<< "  },\n"
+				<< "  \"results\": [";
+		}
+
+		~json_writer() {
+			m_out << (m_first ? "]\n" : "\n  ]\n") << "}\n";
+		}
+
+		void write(const result& r) {
+			m_out << (m_first ? "\n" : ",\n")
+				<< "    {\"algorithm\": " << quote(r.algorithm)
+				<< ", \"type\": " << quote(r.type)
+				<< ", \"distribution\": " << quote(r.distribution)
+				<< ", \"size\": " << r.size
+				<< ", \"min_ns\": " << r.min_ns
+				<< ", \"median_ns\": " << r.median_ns
+				<< ", \"mean_ns\": " << r.mean_ns
+				<< ", \"ns_per_element\": " << (r.size == 0 ? 0.0 : r.min_ns / double(r.size));
+			if (r.comparisons) m_out << ", \"comparisons\": " << *r.comparisons;
+			m_out
+				<< ", \"verified\": " << (r.verified ? "true" : "false") << "}";
+			m_out.flush();
+			m_first = false;
+			m_failed = m_failed || r.verified == false;
+		}
+
+		/**
+		* @brief std::sortの結果と一致しなかった結果があったか
+		*/
+		auto failed() const noexcept -> bool {
+			return m_failed;
+		}
+
+	private:
+		std::ostream& m_out;
+		bool m_first = true;
+		bool m_failed = false;
+	};
+
+	/**
+	* @brief 1回のソートを計測する
+	* @detail 小さい要素数では1回の時間が時計の分解能に埋もれるので、入力のコピーを複数用意してまとめて計測し平均を取る
+	* @detail 結果は整列済みの参照と比べるので、要素を失ったり重複させたりするアルゴリズムも検出できる（同じキーの要素は全て等しい）
+	* @param input 入力
+	* @param expected inputをstd::sortした結果
+	* @return 1回当たりの時間（ns）と、結果が参照と一致したか
+	*/
+	template<typename T, typename Sort>
+	auto measure_once(const std::vector<T>& input, const std::vector<T>& expected, Sort& sort) -> std::pair<double, bool> {
+		const std::size_t batch = std::max<std::size_t>(1, 65536 / std::max<std::size_t>(1, input.size()));
+
+		std::vector<std::vector<T>> copies(batch, input);
+
+		const auto start = std::chrono::steady_clock::now();
+		for (auto& copy : copies) sort(copy.begin(), copy.end(), std::less<T>{});
+		const auto finish = std::chrono::steady_clock::now();
+
+		const bool verified = std::all_of(copies.begin(), copies.end(), [&expected](auto& copy) { return copy == expected; });
+
+		return { std::chrono::duration<double, std::nano>(finish - start).count() / double(batch), verified };
+	}
+
+	/**
+	* @brief 比較回数を数えるファンクタ
+	*/
+	template<typename T>
+	struct counting_less {
+		std::uint64_t* count;
+
+		bool operator()(const T& lhs, const T& rhs) const {
+			++*count;
+			return lhs < rhs;
+		}
+	};
+
+	/**
+	* @brief 1回のソートの比較回数を数える
+	* @return 比較ファンクタを受け取れないアルゴリズムでは無し
+	*/
+	template<typename T, typename Sort>
+	auto count_comparisons(const std::vector<T>& input, Sort& sort) -> std::optional<std::uint64_t> {
+		using iterator = typename std::vector<T>::iterator;
+
+		if constexpr (std::is_invocable_v<Sort&, iterator, iterator, counting_less<T>>) {
+			std::uint64_t count = 0;
+			auto copy = input;
+			sort(copy.begin(), copy.end(), counting_less<T>{ &count });
+			return count;
+		}
+		else {
+			return std::nullopt;
+		}
+	}
+
+	template<typename T>
+	void run_type(const options& opt, json_writer& writer) {
+		if (selected(opt.types, element<T>::name) == false) return;
+
+		for (auto dist : all_distributions) {
+			if (selected(opt.distributions, to_string(dist)) == false) continue;
+
+			for (auto size : opt.sizes) {
+				std::vector<T> input, expected;
+				try {
+					const auto keys = generate_keys(dist, size, opt.seed);
+					input.reserve(size);
+					for (auto key : keys) input.push_back(element<T>::make(key));
+					expected = input;
+					std::sort(expected.begin(), expected.end());
+				}
+				catch (const std::bad_alloc&) {
+					std::cerr << "skip " << element<T>::name << " " << to_string(dist) << " " << size << ": out of memory\n";
+					continue;
+				}
+
+				for_each_algorithm<T>([&](const char* name, bool quadratic, auto sort) {
+					if (selected(opt.algorithms, name) == false) return;
+					if (quadratic && opt.quadratic_limit < size) return;
+
+					std::cerr << name << " " << element<T>::name << " " << to_string(dist) << " " << size << "\n";
+
+					std::vector<double> samples;
+					bool verified = true;
+					std::optional<std::uint64_t> comparisons;
+					try {
+						for (std::size_t i = 0; i < opt.repeat; ++i) {
+							const auto [ns, ok] = measure_once(input, expected, sort);
+							samples.push_back(ns);
+							verified = verified && ok;
+						}
+						if (opt.count_comparisons) comparisons = count_comparisons(input, sort);
+					}
+					catch (const std::bad_alloc&) {
+						std::cerr << "skip " << name << ": out of memory\n";
+						return;
+					}
+
+					std::sort(samples.begin(), samples.end());
+					const auto mean = std::accumulate(samples.begin(), samples.end(), 0.0) / double(samples.size());
+
+					writer.write({ name, element<T>::name, to_string(dist), size, samples.front(), samples[samples.size() / 2], mean, verified, comparisons });
+				});
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	using namespace benchmark;
+
+	const auto opt = parse_options(argc, argv);
+
+	std::ofstream file;
+	if (opt.output != "-") {
+		file.open(opt.output);
+		if (file.is_open() == false) {
+			std::cerr << "failed to open " << opt.output << "\n";
+			return 1;
+		}
+	}
+	std::ostream& out = file.is_open() ? file : std::cout;
+
+	bool failed = false;
+	{
+		json_writer writer{ out, opt };
+
+		run_type<int>(opt, writer);
+		run_type<std::int64_t>(opt, writer);
+		run_type<double>(opt, writer);
+		run_type<record64>(opt, writer);
+		run_type<std::string>(opt, writer);
+
+		failed = writer.failed();
+	}
+
+	if (failed) std::cerr << "some results did not match std::sort\n";
+
+	return (out && failed == false) ? 0 : 1;
+}
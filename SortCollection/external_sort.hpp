@@ -0,0 +1,379 @@
+﻿#pragma once
+
+#include "sort.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+#include <string>
+#include <ios>
+
+namespace sort_collection {
+
+	/**
+	* @brief 外部ソートの設定
+	*/
+	struct external_sort_options {
+		/**
+		* @brief 使用するメモリの上限（バイト）
+		* @detail ランの生成では半分ずつを2つのチャンクに使い、1つを読み込む間にもう1つをソートして書き出す
+		*/
+		std::size_t memory_budget = std::size_t(64) << 20;
+
+		/**
+		* @brief ファイル1つ当たりの入出力バッファの大きさ（バイト）
+		* @detail マージでは各ランに2つずつ割り当てるので、一度にマージするラン数はmemory_budget / (2 * io_buffer_size)で決まる
+		*/
+		std::size_t io_buffer_size = std::size_t(1) << 20;
+
+		/**
+		* @brief ランを書き出すディレクトリ（空ならstd::filesystem::temp_directory_path()）
+		*/
+		std::filesystem::path temporary_directory{};
+	};
+
+	inline namespace algorithm {
+
+		namespace detail {
+
+			/**
+			* @brief 外部ソートの内部処理
+			*/
+			namespace external {
+
+				/**
+				* @brief 入出力エラーを通知する
+				*/
+				[[noreturn]] inline void throw_io_error(const char* what, const std::filesystem::path& path) {
+					throw std::ios_base::failure{ std::string{ what } + ": " + path.string() };
+				}
+
+				/**
+				* @brief 一時ファイル
+				* @detail 破棄時にファイルを削除する
+				*/
+				class temporary_file {
+				public:
+
+					explicit temporary_file(const std::filesystem::path& directory) {
+						static std::atomic<std::uint64_t> counter{ 0 };
+
+						std::random_device seed_gen{};
+						const auto tag = (std::uint64_t(seed_gen()) << 32) ^ seed_gen();
+
+						//他のプロセスと衝突しない名前が見つかるまで作り直す
+						do {
+							m_path = directory / ("sort_collection_" + std::to_string(tag) + "_" + std::to_string(counter.fetch_add(1)) + ".run");
+						} while (std::filesystem::exists(m_path));
+					}
+
+					~temporary_file() {
+						if (m_path.empty()) return;
+
+						std::error_code ec{};
+						std::filesystem::remove(m_path, ec);
+					}
+
+					temporary_file(temporary_file&& other) noexcept
+						: m_path{ std::move(other.m_path) }
+					{
+						other.m_path.clear();
+					}
+
+					temporary_file& operator=(temporary_file&&) = delete;
+
+					auto path() const noexcept -> const std::filesystem::path& {
+						return m_path;
+					}
+
+				private:
+					std::filesystem::path m_path;
+				};
+
+				/**
+				* @brief ファイルから要素を最大count個読み込む
+				* @return 読み込んだ要素数
+				*/
+				template<typename T>
+				auto read_records(std::ifstream& in, const std::filesystem::path& path, T* data, std::size_t count) -> std::size_t {
+					in.read(reinterpret_cast<char*>(data), std::streamsize(count * sizeof(T)));
+					const auto bytes = std::size_t(in.gcount());
+
+					if (in.bad()) throw_io_error("failed to read", path);
+					if (bytes % sizeof(T) != 0) throw_io_error("file size is not a multiple of the record size", path);
+
+					return bytes / sizeof(T);
+				}
+
+				/**
+				* @brief ファイルへ要素をcount個書き込む
+				*/
+				template<typename T>
+				void write_records(std::ofstream& out, const std::filesystem::path& path, const T* data, std::size_t count) {
+					out.write(reinterpret_cast<const char*>(data), std::streamsize(count * sizeof(T)));
+					if (out.fail()) throw_io_error("failed to write", path);
+				}
+
+				/**
+				* @brief ファイルを先頭から順に読む
+				* @detail 2つのバッファを持ち、一方を消費する間にもう一方へ次のブロックを読み込む
+				*/
+				template<typename T>
+				class record_reader {
+				public:
+
+					record_reader(const std::filesystem::path& path, std::size_t buffer_records)
+						: m_path{ path }
+						, m_in{ path, std::ios::binary }
+						, m_current(buffer_records)
+						, m_next(buffer_records)
+					{
+						if (m_in.is_open() == false) throw_io_error("failed to open", m_path);
+
+						m_size = read_records(m_in, m_path, m_current.data(), m_current.size());
+						prefetch();
+					}
+
+					~record_reader() {
+						//先読みがm_inとm_nextを使い終わるまで待つ
+						if (m_pending.valid()) m_pending.wait();
+					}
+
+					record_reader(const record_reader&) = delete;
+					record_reader& operator=(const record_reader&) = delete;
+
+					auto empty() const noexcept -> bool {
+						return m_size == 0;
+					}
+
+					auto front() const noexcept -> const T& {
+						return m_current[m_position];
+					}
+
+					void pop() {
+						if (++m_position == m_size) refill();
+					}
+
+				private:
+
+					void prefetch() {
+						if (m_size < m_current.size()) {
+							//最後まで読み終わっている
+							return;
+						}
+						m_pending = std::async(std::launch::async, [this] { return read_records(m_in, m_path, m_next.data(), m_next.size()); });
+					}
+
+					void refill() {
+						m_position = 0;
+						m_size = 0;
+						if (m_pending.valid() == false) return;
+
+						m_size = m_pending.get();
+						m_current.swap(m_next);
+						prefetch();
+					}
+
+					std::filesystem::path m_path;
+					std::ifstream m_in;
+					std::vector<T> m_current;
+					std::vector<T> m_next;
+					std::size_t m_position = 0;
+					std::size_t m_size = 0;
+					std::future<std::size_t> m_pending;
+				};
+
+				/**
+				* @brief ファイルへ順に書き込む
+				* @detail 2つのバッファを持ち、一方を書き出す間にもう一方へ要素を詰める
+				*/
+				template<typename T>
+				class record_writer {
+				public:
+
+					record_writer(const std::filesystem::path& path, std::size_t buffer_records)
+						: m_path{ path }
+						, m_out{ path, std::ios::binary | std::ios::trunc }
+					{
+						if (m_out.is_open() == false) throw_io_error("failed to open", m_path);
+
+						m_current.reserve(buffer_records);
+						m_next.reserve(buffer_records);
+					}
+
+					~record_writer() {
+						if (m_pending.valid()) m_pending.wait();
+					}
+
+					record_writer(const record_writer&) = delete;
+					record_writer& operator=(const record_writer&) = delete;
+
+					void push(const T& value) {
+						m_current.push_back(value);
+						if (m_current.size() == m_current.capacity()) flush_async();
+					}
+
+					/**
+					* @brief 全ての要素を書き出して閉じる
+					*/
+					void close() {
+						flush_async();
+						if (m_pending.valid()) m_pending.get();
+
+						m_out.close();
+						if (m_out.fail()) throw_io_error("failed to close", m_path);
+					}
+
+				private:
+
+					void flush_async() {
+						if (m_pending.valid()) m_pending.get();
+						if (m_current.empty()) return;
+
+						m_current.swap(m_next);
+						m_current.clear();
+						m_pending = std::async(std::launch::async, [this] { write_records(m_out, m_path, m_next.data(), m_next.size()); });
+					}
+
+					std::filesystem::path m_path;
+					std::ofstream m_out;
+					std::vector<T> m_current;
+					std::vector<T> m_next;
+					std::future<void> m_pending;
+				};
+
+				/**
+				* @brief ソート済みのファイル群をk-wayマージしてoutputへ書き出す
+				* @detail 敗者木で先頭が最も前に並ぶファイルを選ぶ。同値の要素は前のファイルのものが先に並ぶ
+				*/
+				template<typename T, typename Compare>
+				void merge_files(const std::vector<std::filesystem::path>& inputs, const std::filesystem::path& output, Compare& comp, std::size_t buffer_records) {
+					std::vector<std::unique_ptr<record_reader<T>>> readers;
+					readers.reserve(inputs.size());
+					for (auto& path : inputs) readers.push_back(std::make_unique<record_reader<T>>(path, buffer_records));
+
+					//読み終わったファイルは負け、同値は前のファイルが勝つ
+					auto beats = [&](std::size_t lhs, std::size_t rhs) {
+						if (readers[lhs]->empty()) return false;
+						if (readers[rhs]->empty()) return true;
+						const auto& l = readers[lhs]->front();
+						const auto& r = readers[rhs]->front();
+						return (lhs < rhs) ? comp(r, l) == false : comp(l, r);
+					};
+
+					loser_tree<decltype(beats)> tree{ readers.size(), beats };
+
+					record_writer<T> writer{ output, buffer_records };
+
+					while (true) {
+						auto& reader = *readers[tree.winner()];
+						if (reader.empty()) break;
+
+						writer.push(reader.front());
+						reader.pop();
+						tree.replay();
+					}
+
+					writer.close();
+				}
+			}
+		}
+
+		/**
+		* @brief 外部マージソート
+		* @detail メモリに収まらないファイルを、メモリに収まる大きさのランに分けてソートし一時ファイルへ書き出してから、k-wayマージする
+		* @detail 入力ファイルはT型の値をそのまま並べたバイナリファイルとし、結果も同じ形式でoutputへ書き出す
+		* @detail ランの読み込み・ソート・書き出しと、マージ時の読み込み・書き出しはそれぞれ並行して行う
+		* @tparam SortAlgorithm ランのソートに使用するアルゴリズム（安定なアルゴリズムなら全体も安定になる）
+		* @tparam T 要素型（トリビアルコピー可能であること）
+		* @param input 入力ファイル
+		* @param output 出力ファイル（inputと同じファイルでもよい）
+		* @param comp 比較に使うファンクタ
+		* @param options 使用するメモリ量や一時ファイルの場所
+		*/
+		template<typename SortAlgorithm, typename T, typename Compare = std::less<T>>
+		void external_sort(const std::filesystem::path& input, const std::filesystem::path& output, Compare comp = Compare{}, const external_sort_options& options = {}) {
+			static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>, "external_sort requires trivially copyable records.");
+
+			using detail::external::temporary_file;
+
+			const auto directory = options.temporary_directory.empty() ? std::filesystem::temp_directory_path() : options.temporary_directory;
+			const auto chunk_records = std::max<std::size_t>(1, options.memory_budget / 2 / sizeof(T));
+			const auto buffer_records = std::max<std::size_t>(1, options.io_buffer_size / sizeof(T));
+			const auto fan_in = std::max<std::size_t>(2, options.memory_budget / (2 * options.io_buffer_size));
+
+			std::vector<temporary_file> runs;
+
+			//ランの生成：一方のチャンクへ読み込む間に、もう一方をソートして書き出す
+			{
+				std::ifstream in{ input, std::ios::binary };
+				if (in.is_open() == false) detail::external::throw_io_error("failed to open", input);
+
+				std::vector<T> chunks[2];
+				std::future<void> pending;
+
+				for (std::size_t i = 0; ; ++i) {
+					auto& chunk = chunks[i % 2];
+					chunk.resize(chunk_records);
+					chunk.resize(detail::external::read_records(in, input, chunk.data(), chunk.size()));
+
+					//前のチャンクの書き出しを待つ（ここでチャンクとcompが空く）
+					if (pending.valid()) pending.get();
+					if (chunk.empty()) break;
+
+					runs.emplace_back(directory);
+					pending = std::async(std::launch::async, [&chunk, &comp, &path = runs.back().path()] {
+						sort_collection::sort<SortAlgorithm>(std::begin(chunk), std::end(chunk), comp);
+
+						std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+						if (out.is_open() == false) detail::external::throw_io_error("failed to open", path);
+						detail::external::write_records(out, path, chunk.data(), chunk.size());
+						out.close();
+						if (out.fail()) detail::external::throw_io_error("failed to close", path);
+					});
+
+					if (chunk.size() < chunk_records) {
+						pending.get();
+						break;
+					}
+				}
+			}
+
+			if (runs.empty()) {
+				//空のファイル
+				std::ofstream out{ output, std::ios::binary | std::ios::trunc };
+				if (out.is_open() == false) detail::external::throw_io_error("failed to open", output);
+				return;
+			}
+
+			//ラン数がfan_in以下になるまで、先頭から順にまとめてマージする
+			while (fan_in < runs.size()) {
+				std::vector<temporary_file> merged;
+
+				for (std::size_t first = 0; first < runs.size(); first += fan_in) {
+					const auto last = std::min(first + fan_in, runs.size());
+
+					if (last - first == 1) {
+						merged.push_back(std::move(runs[first]));
+						continue;
+					}
+
+					std::vector<std::filesystem::path> paths;
+					for (auto i = first; i < last; ++i) paths.push_back(runs[i].path());
+
+					merged.emplace_back(directory);
+					detail::external::merge_files<T>(paths, merged.back().path(), comp, buffer_records);
+				}
+
+				runs = std::move(merged);
+			}
+
+			//最後のマージ
+			std::vector<std::filesystem::path> paths;
+			for (auto& run : runs) paths.push_back(run.path());
+
+			detail::external::merge_files<T>(paths, output, comp, buffer_records);
+		}
+	}
+}
@@ -4,9 +4,386 @@
 #include <iterator>
 #include <utility>
 #include <memory>
+#include <memory_resource>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <execution>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <list>
+#include <forward_list>
+#include <functional>
+#include <exception>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <new>
+
+#if !defined(SORT_COLLECTION_DISABLE_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || (defined(_M_IX86) && !defined(_M_ARM64EC)))
+#define SORT_COLLECTION_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+//SORT_COLLECTION_INSTRUMENTATIONを定義すると、アルゴリズム内部の作業領域の確保と再帰の深さを記録する
+#if defined(SORT_COLLECTION_INSTRUMENTATION)
+#define SORT_COLLECTION_INSTRUMENT_WORKSPACE(bytes) ::sort_collection::instrumentation::detail::record_workspace(bytes)
+#define SORT_COLLECTION_INSTRUMENT_RECURSION() const ::sort_collection::instrumentation::detail::recursion_guard sort_collection_recursion_guard{}
+#else
+#define SORT_COLLECTION_INSTRUMENT_WORKSPACE(bytes) ((void)0)
+#define SORT_COLLECTION_INSTRUMENT_RECURSION() ((void)0)
+#endif
+
+//x86-64ではSSE2を常に使える
+#if !defined(SORT_COLLECTION_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP))
+#define SORT_COLLECTION_SSE2
+#include <emmintrin.h>
+#endif
+
+//GCC/Clangでは関数単位で命令セットを有効にする（MSVCは指定せずに使用できる）
+#if defined(SORT_COLLECTION_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SORT_COLLECTION_TARGET_AVX2 __attribute__((target("avx2")))
+#define SORT_COLLECTION_TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#define SORT_COLLECTION_TARGET_AVX2
+#define SORT_COLLECTION_TARGET_SSE41
+#endif
 
 namespace sort_collection {
 
+	/**
+	* @brief 操作回数の計測
+	* @detail counted<T>とcounted_compareで包んだ範囲をソートすると、比較・交換・ムーブ・コピーの回数を数える
+	* @detail SORT_COLLECTION_INSTRUMENTATIONを定義すると、作業領域の確保量と再帰の深さもアルゴリズム内部から記録する
+	* @detail どちらも使わなければ、アルゴリズムには何も追加されない
+	*/
+	namespace instrumentation {
+
+		/**
+		* @brief 計測結果
+		*/
+		struct operation_counts {
+			//比較の回数
+			std::uint64_t comparisons = 0;
+			//交換の回数
+			std::uint64_t swaps = 0;
+			//ムーブ構築・ムーブ代入の回数
+			std::uint64_t moves = 0;
+			//コピー構築・コピー代入の回数
+			std::uint64_t copies = 0;
+			//作業領域として確保したバイト数の合計
+			std::uint64_t workspace_bytes = 0;
+			//再帰の最大の深さ
+			std::uint64_t max_recursion_depth = 0;
+		};
+
+		namespace detail {
+
+			/**
+			* @brief 計測中のカウンタ
+			* @detail 並列アルゴリズムのワーカースレッドからも加算されるのでアトミックに数える
+			*/
+			struct counters {
+				std::atomic<std::uint64_t> comparisons{ 0 };
+				std::atomic<std::uint64_t> swaps{ 0 };
+				std::atomic<std::uint64_t> moves{ 0 };
+				std::atomic<std::uint64_t> copies{ 0 };
+				std::atomic<std::uint64_t> workspace_bytes{ 0 };
+				std::atomic<std::uint64_t> max_recursion_depth{ 0 };
+			};
+
+			/**
+			* @brief 計測中のカウンタ（計測していなければnullptr）
+			*/
+			inline std::atomic<counters*> active{ nullptr };
+
+			inline void add(std::atomic<std::uint64_t> counters::* counter, std::uint64_t n = 1) noexcept {
+				if (auto* target = active.load(std::memory_order_relaxed)) {
+					(target->*counter).fetch_add(n, std::memory_order_relaxed);
+				}
+			}
+
+			/**
+			* @brief 作業領域の確保を記録する
+			*/
+			inline void record_workspace(std::size_t bytes) noexcept {
+				add(&counters::workspace_bytes, bytes);
+			}
+
+			/**
+			* @brief 再帰の深さを記録する
+			* @detail スレッド毎に深さを数えるので、並列版では各タスク内での深さになる
+			*/
+			class recursion_guard {
+			public:
+
+				recursion_guard() noexcept {
+					const auto current = ++depth;
+
+					if (auto* target = active.load(std::memory_order_relaxed)) {
+						auto max = target->max_recursion_depth.load(std::memory_order_relaxed);
+						while (max < current && target->max_recursion_depth.compare_exchange_weak(max, current, std::memory_order_relaxed) == false) {}
+					}
+				}
+
+				~recursion_guard() {
+					--depth;
+				}
+
+				recursion_guard(const recursion_guard&) = delete;
+				recursion_guard& operator=(const recursion_guard&) = delete;
+
+			private:
+				static inline thread_local std::uint64_t depth = 0;
+			};
+		}
+
+		/**
+		* @brief 計測範囲
+		* @detail 生存している間の操作を数える。入れ子にした場合は内側の範囲だけが数え、破棄されると外側に戻る
+		*/
+		class scope {
+		public:
+
+			scope() noexcept
+				: m_previous{ detail::active.exchange(&m_counters) }
+			{}
+
+			~scope() {
+				detail::active.store(m_previous);
+			}
+
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+
+			/**
+			* @brief ここまでの計測結果
+			*/
+			auto counts() const noexcept -> operation_counts {
+				operation_counts result{};
+				result.comparisons = m_counters.comparisons.load();
+				result.swaps = m_counters.swaps.load();
+				result.moves = m_counters.moves.load();
+				result.copies = m_counters.copies.load();
+				result.workspace_bytes = m_counters.workspace_bytes.load();
+				result.max_recursion_depth = m_counters.max_recursion_depth.load();
+				return result;
+			}
+
+		private:
+			detail::counters m_counters;
+			detail::counters* m_previous;
+		};
+
+		/**
+		* @brief ムーブ・コピー・交換・比較を数える要素の包み
+		* @tparam T 包む要素型
+		*/
+		template<typename T>
+		struct counted {
+			T value;
+
+			counted() = default;
+
+			template<typename... Args, std::enable_if_t<std::is_constructible_v<T, Args&&...>, std::nullptr_t> = nullptr>
+			explicit counted(std::in_place_t, Args&&... args)
+				: value(std::forward<Args>(args)...)
+			{}
+
+			counted(const counted& other)
+				: value(other.value)
+			{
+				detail::add(&detail::counters::copies);
+			}
+
+			counted(counted&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+				: value(std::move(other.value))
+			{
+				detail::add(&detail::counters::moves);
+			}
+
+			counted& operator=(const counted& other) {
+				value = other.value;
+				detail::add(&detail::counters::copies);
+				return *this;
+			}
+
+			counted& operator=(counted&& other) noexcept(std::is_nothrow_move_assignable_v<T>) {
+				value = std::move(other.value);
+				detail::add(&detail::counters::moves);
+				return *this;
+			}
+
+			/**
+			* @brief 交換は1回の交換として数え、内部のムーブは数えない
+			*/
+			friend void swap(counted& lhs, counted& rhs) noexcept(std::is_nothrow_swappable_v<T>) {
+				using std::swap;
+				swap(lhs.value, rhs.value);
+				detail::add(&detail::counters::swaps);
+			}
+
+			friend bool operator<(const counted& lhs, const counted& rhs) {
+				detail::add(&detail::counters::comparisons);
+				return lhs.value < rhs.value;
+			}
+
+			friend bool operator>(const counted& lhs, const counted& rhs) {
+				detail::add(&detail::counters::comparisons);
+				return rhs.value < lhs.value;
+			}
+		};
+
+		/**
+		* @brief 比較の回数を数える比較ファンクタの包み
+		* @detail counted<T>の引数は中身を取り出してから比較する
+		* @tparam Compare 包む比較ファンクタ型
+		*/
+		template<typename Compare>
+		struct counted_compare {
+			Compare comp;
+
+			template<typename L, typename R>
+			auto operator()(const L& lhs, const R& rhs) -> bool {
+				detail::add(&detail::counters::comparisons);
+				return comp(unwrap(lhs), unwrap(rhs));
+			}
+
+		private:
+
+			template<typename T>
+			static auto unwrap(const counted<T>& v) noexcept -> const T& {
+				return v.value;
+			}
+
+			template<typename T>
+			static auto unwrap(const T& v) noexcept -> const T& {
+				return v;
+			}
+		};
+
+		template<typename Compare>
+		counted_compare(Compare) -> counted_compare<Compare>;
+	}
+
+	/**
+	* @brief ソートに使う作業領域
+	* @detail 未初期化の領域を保持する。ソートの間だけ要素が構築され、終了時には全て破棄されている
+	* @detail 容量は必要な時だけ増えて縮まないので、同じ作業領域を使い回せば確保は最初の1回で済む
+	* @tparam T 要素型
+	* @tparam Allocator 領域の確保に使うアロケータ
+	*/
+	template<typename T, typename Allocator = std::allocator<T>>
+	class workspace {
+		using alloc_traits = std::allocator_traits<Allocator>;
+
+	public:
+		using value_type = T;
+		using allocator_type = Allocator;
+		using size_type = std::size_t;
+
+		workspace() = default;
+
+		explicit workspace(const Allocator& alloc) noexcept
+			: m_alloc(alloc)
+		{}
+
+		/**
+		* @param capacity 予め確保しておく要素数
+		* @param alloc 領域の確保に使うアロケータ
+		*/
+		explicit workspace(size_type capacity, const Allocator& alloc = Allocator())
+			: m_alloc(alloc)
+		{
+			reserve(capacity);
+		}
+
+		workspace(workspace&& other) noexcept
+			: m_alloc(std::move(other.m_alloc))
+			, m_data(std::exchange(other.m_data, nullptr))
+			, m_capacity(std::exchange(other.m_capacity, 0))
+		{}
+
+		workspace& operator=(workspace&& other) noexcept {
+			if (this != &other) {
+				release();
+				m_alloc = std::move(other.m_alloc);
+				m_data = std::exchange(other.m_data, nullptr);
+				m_capacity = std::exchange(other.m_capacity, 0);
+			}
+			return *this;
+		}
+
+		workspace(const workspace&) = delete;
+		workspace& operator=(const workspace&) = delete;
+
+		~workspace() {
+			release();
+		}
+
+		/**
+		* @brief 少なくともn要素分の領域を確保する
+		* @detail 領域に要素は残っていないので、拡張時に中身の移動はしない
+		* @param n 必要な要素数
+		*/
+		void reserve(size_type n) {
+			if (n <= m_capacity) return;
+
+			auto new_data = alloc_traits::allocate(m_alloc, n);
+			SORT_COLLECTION_INSTRUMENT_WORKSPACE(n * sizeof(T));
+			release();
+			m_data = new_data;
+			m_capacity = n;
+		}
+
+		auto data() const noexcept -> T* {
+			return (m_data == nullptr) ? nullptr : std::addressof(*m_data);
+		}
+
+		auto capacity() const noexcept -> size_type {
+			return m_capacity;
+		}
+
+		auto get_allocator() const noexcept -> allocator_type {
+			return m_alloc;
+		}
+
+	private:
+
+		void release() noexcept {
+			if (m_data != nullptr) {
+				alloc_traits::deallocate(m_alloc, m_data, m_capacity);
+				m_data = nullptr;
+				m_capacity = 0;
+			}
+		}
+
+		Allocator m_alloc{};
+		typename alloc_traits::pointer m_data = nullptr;
+		size_type m_capacity = 0;
+	};
+
+	namespace pmr {
+
+		/**
+		* @brief std::pmr::memory_resourceから確保する作業領域
+		* @tparam T 要素型
+		*/
+		template<typename T>
+		using workspace = sort_collection::workspace<T, std::pmr::polymorphic_allocator<T>>;
+	}
+
 	/**
 	* @brief 各種ソートアルゴリズムを定義
 	*/
@@ -17,6 +394,70 @@ namespace sort_collection {
 		*/
 		namespace detail {
 
+			/**
+			* @brief 標準の比較ファンクタ（std::less, std::greater）かを判定する
+			* @detail これらは比較結果が要素の値だけで決まるので、分岐を避けた実装に置き換えられる
+			* @tparam Compare 比較ファンクタ型
+			* @tparam T 比較する要素型
+			*/
+			template<typename Compare, typename T>
+			inline constexpr bool is_standard_compare_v = std::disjunction_v<
+				std::is_same<std::remove_cv_t<std::remove_reference_t<Compare>>, std::less<T>>,
+				std::is_same<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<T>>,
+				std::is_same<std::remove_cv_t<std::remove_reference_t<Compare>>, std::less<>>,
+				std::is_same<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<>>
+			>;
+
+			/**
+			* @brief 降順の標準の比較ファンクタ（std::greater）か
+			*/
+			template<typename Compare, typename T>
+			inline constexpr bool is_greater_compare_v = std::is_same_v<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<T>> || std::is_same_v<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<>>;
+
+			/**
+			* @brief 分岐しないcompare_and_swap()を使うか
+			* @detail 標準の比較ファンクタ（std::less, std::greater）で、算術型・列挙型・ポインタを比較する場合に使う
+			* @detail SORT_COLLECTION_DISABLE_BRANCHLESSを定義すると使わない
+			*/
+#if defined(SORT_COLLECTION_DISABLE_BRANCHLESS)
+			template<typename Iterator, typename Compare>
+			inline constexpr bool is_branchless_compare_and_swap_v = false;
+#else
+			template<typename Iterator, typename Compare, typename T = typename std::iterator_traits<Iterator>::value_type>
+			inline constexpr bool is_branchless_compare_and_swap_v = is_standard_compare_v<Compare, T> && std::is_same_v<typename std::iterator_traits<Iterator>::reference, T&> && (std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>);
+#endif
+
+			/**
+			* @brief 定数評価中かを判定する
+			* @detail C++17にはstd::is_constant_evaluated()がないので、対応する処理系では組み込み関数を使う。使えなければ常にfalse
+			*/
+			constexpr bool is_constant_evaluated() noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+				return std::is_constant_evaluated();
+#elif (defined(__GNUC__) && 9 <= __GNUC__) || (defined(__clang__) && 9 <= __clang_major__) || (defined(_MSC_VER) && 1925 <= _MSC_VER)
+				return __builtin_is_constant_evaluated();
+#else
+				return false;
+#endif
+			}
+
+			/**
+			* @brief イテレータの指す要素を入れ替える
+			* @detail 通常はADLで見つかるswapを使う。C++17のstd::swapはconstexprでないので、定数評価中は一時オブジェクトを介してムーブする
+			*/
+			template<typename Iterator>
+			constexpr void iter_swap(Iterator lhs, Iterator rhs) {
+				if (is_constant_evaluated()) {
+					typename std::iterator_traits<Iterator>::value_type tmp = std::move(*lhs);
+					*lhs = std::move(*rhs);
+					*rhs = std::move(tmp);
+				}
+				else {
+					using std::swap;
+					swap(*lhs, *rhs);
+				}
+			}
+
 			/**
 			* @brief 必要ならスワップする
 			* @detail comp(*lhs, *rhs) == trueならswap(*lhs, *rhs)
@@ -27,12 +468,46 @@ namespace sort_collection {
 			*/
 			template<typename Iterator, typename Compare>
 			constexpr auto compare_and_swap(Iterator lhs, Iterator rhs, Compare&& comp) -> bool {
-				if (comp(*lhs, *rhs)) {
-					using std::swap;
-					swap(*lhs, *rhs);
-					return true;
+				using value_t = typename std::iterator_traits<Iterator>::value_type;
+
+				if constexpr (is_branchless_compare_and_swap_v<Iterator, Compare>) {
+					const value_t l = *lhs;
+					const value_t r = *rhs;
+					const bool swapped = comp(l, r);
+
+#if defined(SORT_COLLECTION_SSE2)
+					if constexpr (std::is_same_v<value_t, float> || std::is_same_v<value_t, double>) {
+						//浮動小数点数の三項演算子は分岐になるので、比較結果のマスクで選ぶ（定数評価中は下の三項演算子で）
+						if (is_constant_evaluated() == false) {
+							constexpr bool descending = is_greater_compare_v<Compare, value_t>;
+							if constexpr (std::is_same_v<value_t, float>) {
+								const auto vl = _mm_set_ss(l), vr = _mm_set_ss(r);
+								const auto mask = descending ? _mm_cmpgt_ss(vl, vr) : _mm_cmplt_ss(vl, vr);
+								*lhs = _mm_cvtss_f32(_mm_or_ps(_mm_and_ps(mask, vr), _mm_andnot_ps(mask, vl)));
+								*rhs = _mm_cvtss_f32(_mm_or_ps(_mm_and_ps(mask, vl), _mm_andnot_ps(mask, vr)));
+							}
+							else {
+								const auto vl = _mm_set_sd(l), vr = _mm_set_sd(r);
+								const auto mask = descending ? _mm_cmpgt_sd(vl, vr) : _mm_cmplt_sd(vl, vr);
+								*lhs = _mm_cvtsd_f64(_mm_or_pd(_mm_and_pd(mask, vr), _mm_andnot_pd(mask, vl)));
+								*rhs = _mm_cvtsd_f64(_mm_or_pd(_mm_and_pd(mask, vl), _mm_andnot_pd(mask, vr)));
+							}
+							return swapped;
+						}
+					}
+#endif
+					//整数型は値をコピーしてから選び直すと、条件付き移動（cmov）になる
+					*lhs = swapped ? r : l;
+					*rhs = swapped ? l : r;
+					return swapped;
+				}
+				else {
+					if (comp(*lhs, *rhs)) {
+						detail::iter_swap(lhs, rhs);
+						return true;
+					}
+					return false;
 				}
-				return false;
 			}
 
 			/**
@@ -51,6 +526,10 @@ namespace sort_collection {
 					struct merge {};
 
 					struct partitioning {};
+
+					struct distribution {};
+
+					struct hybrid {};
 				}
 
 			}
@@ -68,437 +547,5978 @@ namespace sort_collection {
 			*/
 			template<typename Iterator>
 			inline constexpr auto comp_v = default_compare<Iterator>{};
-		}
 
+			/**
+			* @brief 実行ポリシー型かを判定する
+			* @tparam ExecutionPolicy 判定する型
+			*/
+			template<typename ExecutionPolicy>
+			inline constexpr bool is_execution_policy_v = std::is_execution_policy_v<std::remove_cv_t<std::remove_reference_t<ExecutionPolicy>>>;
 
-		/**
-		* @brief バブルソート
-		*/
-		struct bubble_sort {
-			static constexpr bool stable = true;
+			/**
+			* @brief 並列実行を許可する実行ポリシー型かを判定する
+			* @detail sequenced_policy以外の実行ポリシーならtrue
+			* @tparam ExecutionPolicy 判定する型
+			*/
+			template<typename ExecutionPolicy>
+			inline constexpr bool is_parallel_policy_v = is_execution_policy_v<ExecutionPolicy> && !std::is_same_v<std::remove_cv_t<std::remove_reference_t<ExecutionPolicy>>, std::execution::sequenced_policy>;
 
-			using method = detail::category::method::swap;
+			/**
+			* @brief イテレータがRandomAccessIteratorかを判定する
+			* @tparam Iterator 判定するイテレータ型
+			*/
+			template<typename Iterator>
+			inline constexpr bool is_random_access_iterator_v = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
 
+			template<typename T, typename = void>
+			struct is_range : std::false_type {};
 
-			template<typename BidirectionalIterator, typename Compare>
-			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
-				if (begin == end) return;
+			template<typename T>
+			struct is_range<T, std::void_t<decltype(std::begin(std::declval<T&>())), decltype(std::end(std::declval<T&>()))>> : std::true_type {};
 
-				//入れ替えが行われなかった回数（後ろから見て並んでる個数）を記録
-				int count{};
+			/**
+			* @brief begin()/end()で範囲を取り出せる型かを判定する
+			* @tparam T 判定する型
+			*/
+			template<typename T>
+			inline constexpr bool is_range_v = is_range<T>::value;
 
-				//後ろから連続してcount回入れ替えられていなければ（=並んでいる）、その分後ろを減らす（見に行かなくする）
-				for (auto loopend = end - 1; loopend != begin; std::advance(loopend, -count)) {
-					count = 0;
-					for (auto current = begin; current != loopend; ++current) {
-						if (detail::compare_and_swap(current + 1, current,comp) == false)++count;
-						else count = 0;
-					}
-					if (count == 0) ++count;
-				}
-			}
+			template<typename SortAlgorithm, typename ExecutionPolicy, typename Iterator, typename Compare, typename = void>
+			struct has_execution_policy_sort : std::false_type {};
 
-			template<typename BidirectionalIterator, typename Compare>
-			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
-			}
-		};
+			template<typename SortAlgorithm, typename ExecutionPolicy, typename Iterator, typename Compare>
+			struct has_execution_policy_sort<SortAlgorithm, ExecutionPolicy, Iterator, Compare, std::void_t<decltype(SortAlgorithm::sort(std::declval<ExecutionPolicy>(), std::declval<Iterator>(), std::declval<Iterator>(), std::declval<Compare>()))>> : std::true_type {};
 
-		/**
-		* @brief シェイカーソート
-		*/
-		struct shaker_sort {
-			static constexpr bool stable = true;
+			/**
+			* @brief アルゴリズムが実行ポリシーを受け取るsort()を持つかを判定する
+			*/
+			template<typename SortAlgorithm, typename ExecutionPolicy, typename Iterator, typename Compare>
+			inline constexpr bool has_execution_policy_sort_v = has_execution_policy_sort<SortAlgorithm, ExecutionPolicy, Iterator, Compare>::value;
 
-			using method = detail::category::method::swap;
-			
-			template<typename BidirectionalIterator, typename Compare>
-			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
-				if (begin == end) return;
-				
-				//左端と右端
-				auto far_left = begin;
-				auto far_right = end - 1;
-				//最後に入れ替えが起きた場所
-				auto last_swap = begin;
+			template<typename T>
+			struct is_linked_list : std::false_type {};
 
-				while (far_left != far_right)
-				{
-					//右から左
-					for (auto current = far_left; current != far_right; ++current) {
-						if (detail::compare_and_swap(current + 1, current, comp) == true)last_swap = current;
-					}
+			template<typename T, typename Allocator>
+			struct is_linked_list<std::list<T, Allocator>> : std::true_type {};
 
-					if (far_left == last_swap) return;
+			template<typename T, typename Allocator>
+			struct is_linked_list<std::forward_list<T, Allocator>> : std::true_type {};
 
-					//右端狭める
-					far_right = last_swap;
+			/**
+			* @brief ノードを繋ぎ替えられる連結リスト（std::list、std::forward_list）かを判定する
+			*/
+			template<typename T>
+			inline constexpr bool is_linked_list_v = is_linked_list<T>::value;
 
-					//左から右
-					for (auto current = far_right; current != far_left; --current) {
-						if (detail::compare_and_swap(current, current - 1, comp) == true)last_swap = current;
-					}
+			template<typename SortAlgorithm, typename Container, typename Compare, typename = void>
+			struct has_container_sort : std::false_type {};
 
-					//左端狭める
-					far_left = last_swap;
-				}
-			}
+			template<typename SortAlgorithm, typename Container, typename Compare>
+			struct has_container_sort<SortAlgorithm, Container, Compare, std::void_t<decltype(SortAlgorithm::sort(std::declval<Container&>(), std::declval<Compare>()))>> : std::true_type {};
 
-			template<typename BidirectionalIterator, typename Compare>
-			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
-			}
-		};
+			/**
+			* @brief アルゴリズムがコンテナを直接受け取るsort()を持つかを判定する
+			* @detail std::list等のノードを繋ぎ替えてソートできるコンテナ向け
+			*/
+			template<typename SortAlgorithm, typename Container, typename Compare>
+			inline constexpr bool has_container_sort_v = has_container_sort<SortAlgorithm, Container, Compare>::value;
 
-		/**
-		* @brief コムソート（コムソート11）
-		*/
-		struct comb_sort {
-			static constexpr bool stable = false;
+			/**
+			* @brief ワークスティーリングを行うスレッドプール
+			* @detail ワーカー毎に両端キューを持ち、自分のキューは後ろから（LIFO）、他のキューは前から（FIFO）取り出して実行する
+			*/
+			class thread_pool {
+				using task_t = std::function<void()>;
 
-			using method = detail::category::method::swap;
+				struct task_queue {
+					std::mutex mtx;
+					std::deque<task_t> tasks;
+				};
 
-			template<typename ForwardIterator, typename Compare>
-			static constexpr void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) {
-				//イテレータ間距離の型
-				using diff_t = typename std::iterator_traits<ForwardIterator>::difference_type;
+			public:
 
-				//h = h / 1.3 を求める
-				constexpr auto calc_h = [](const diff_t N) -> diff_t { 
-					if (N == diff_t(1)) return N;
-					else {
-						auto h = static_cast<diff_t>(std::trunc(N / 1.3));
-						//Comb sort 11
-						if (h == diff_t(9) || h == diff_t(10))return diff_t(11);
-						return h;
+				/**
+				* @param worker_count 起動するワーカースレッド数（0なら呼び出し側スレッドだけで実行する）
+				*/
+				explicit thread_pool(std::size_t worker_count)
+					//末尾の1つはワーカー以外のスレッドから投入されたタスク用
+					: m_queues(worker_count + 1)
+				{
+					m_threads.reserve(worker_count);
+					for (std::size_t i = 0; i < worker_count; ++i) {
+						m_threads.emplace_back([this, i] { worker_loop(i); });
 					}
-				};
+				}
+
+				~thread_pool() {
+					{
+						std::lock_guard<std::mutex> lock{ m_sleep_mtx };
+						m_stop = true;
+					}
+					m_cv.notify_all();
+					for (auto& th : m_threads) th.join();
+				}
+
+				thread_pool(const thread_pool&) = delete;
+				thread_pool& operator=(const thread_pool&) = delete;
+
+				/**
+				* @brief 全アルゴリズムで共有するスレッドプール
+				* @detail 呼び出し側スレッドも待機中にタスクを実行するので、ワーカーはハードウェアスレッド数-1だけ起動する
+				*/
+				static auto instance() -> thread_pool& {
+					static thread_pool pool{ std::size_t(std::max(1u, std::thread::hardware_concurrency()) - 1) };
+					return pool;
+				}
+
+				/**
+				* @brief 呼び出し側スレッドを含めた並列度
+				*/
+				auto concurrency() const noexcept -> std::size_t {
+					return m_threads.size() + 1;
+				}
+
+				/**
+				* @brief タスクを投入する
+				* @detail ワーカーから呼ばれた場合は自分のキューに積む
+				* @param task 実行するタスク
+				*/
+				void submit(task_t task) {
+					auto& queue = m_queues[this_queue_index()];
+
+					//取り出し側が負の値を見ないように、先に数を増やしておく
+					m_pending.fetch_add(1, std::memory_order_acq_rel);
+					{
+						std::lock_guard<std::mutex> lock{ queue.mtx };
+						queue.tasks.push_back(std::move(task));
+					}
+					{
+						std::lock_guard<std::mutex> lock{ m_sleep_mtx };
+					}
+					m_cv.notify_one();
+				}
+
+				/**
+				* @brief キューからタスクを1つ取り出して実行する
+				* @return タスクを実行したか
+				*/
+				auto try_run_one() -> bool {
+					task_t task;
+					if (try_pop(this_queue_index(), task) == false) return false;
+					task();
+					return true;
+				}
+
+			private:
+
+				auto this_queue_index() const noexcept -> std::size_t {
+					return (tls_owner == this) ? tls_index : m_queues.size() - 1;
+				}
+
+				auto try_pop(std::size_t self, task_t& task) -> bool {
+					//自分のキューの後ろから
+					{
+						auto& queue = m_queues[self];
+						std::lock_guard<std::mutex> lock{ queue.mtx };
+						if (queue.tasks.empty() == false) {
+							task = std::move(queue.tasks.back());
+							queue.tasks.pop_back();
+							m_pending.fetch_sub(1, std::memory_order_acq_rel);
+							return true;
+						}
+					}
+
+					//他のキューの前から盗む
+					const auto count = m_queues.size();
+					for (std::size_t i = 1; i < count; ++i) {
+						auto& queue = m_queues[(self + i) % count];
+						std::lock_guard<std::mutex> lock{ queue.mtx };
+						if (queue.tasks.empty() == false) {
+							task = std::move(queue.tasks.front());
+							queue.tasks.pop_front();
+							m_pending.fetch_sub(1, std::memory_order_acq_rel);
+							return true;
+						}
+					}
+
+					return false;
+				}
+
+				void worker_loop(std::size_t index) {
+					tls_owner = this;
+					tls_index = index;
+
+					while (true) {
+						if (try_run_one()) continue;
+
+						std::unique_lock<std::mutex> lock{ m_sleep_mtx };
+						m_cv.wait(lock, [this] { return m_stop || 0 < m_pending.load(std::memory_order_acquire); });
+						if (m_stop && m_pending.load(std::memory_order_acquire) == 0) return;
+					}
+				}
+
+				static inline thread_local const thread_pool* tls_owner = nullptr;
+				static inline thread_local std::size_t tls_index = 0;
+
+				std::vector<task_queue> m_queues;
+				std::vector<std::thread> m_threads;
+				std::atomic<std::ptrdiff_t> m_pending{ 0 };
+				std::mutex m_sleep_mtx;
+				std::condition_variable m_cv;
+				bool m_stop = false;
+			};
+
+			/**
+			* @brief fork-join用のタスクのまとまり
+			* @detail wait()中は呼び出し側スレッドもプールのタスクを実行する（入れ子にしてもデッドロックしない）
+			*/
+			class task_group {
+			public:
+
+				explicit task_group(thread_pool& pool) noexcept
+					: m_pool(pool)
+				{}
+
+				~task_group() {
+					//投げられた例外は捨て、実行中のタスクの完了だけ待つ
+					help_until_done();
+				}
+
+				task_group(const task_group&) = delete;
+				task_group& operator=(const task_group&) = delete;
+
+				/**
+				* @brief タスクを投入する
+				* @param f 実行する関数（コピー可能であること）
+				*/
+				template<typename F>
+				void run(F&& f) {
+					m_pending.fetch_add(1, std::memory_order_acq_rel);
+					m_pool.submit([this, f = std::forward<F>(f)]() mutable {
+						try {
+							f();
+						}
+						catch (...) {
+							std::lock_guard<std::mutex> lock{ m_mtx };
+							if (!m_exception) m_exception = std::current_exception();
+						}
+						m_pending.fetch_sub(1, std::memory_order_release);
+					});
+				}
+
+				/**
+				* @brief 投入したタスクが全て終わるまで待つ
+				* @detail タスクが例外を投げていた場合、最初の1つを再送出する
+				*/
+				void wait() {
+					help_until_done();
+					if (m_exception) std::rethrow_exception(std::exchange(m_exception, nullptr));
+				}
+
+			private:
+
+				void help_until_done() noexcept {
+					while (m_pending.load(std::memory_order_acquire) != 0) {
+						if (m_pool.try_run_one() == false) std::this_thread::yield();
+					}
+				}
+
+				thread_pool& m_pool;
+				std::atomic<std::size_t> m_pending{ 0 };
+				std::mutex m_mtx;
+				std::exception_ptr m_exception;
+			};
+
+			/**
+			* @brief 恒等射影
+			*/
+			struct identity {
+				template<typename T>
+				constexpr auto operator()(T&& value) const noexcept -> T&& {
+					return std::forward<T>(value);
+				}
+			};
+
+			/**
+			* @brief 基数ソートのキーを、大小関係を保ったまま符号なし整数へ変換する
+			* @detail 符号付き整数は符号ビットを反転し、浮動小数点数は負なら全ビットを、正なら符号ビットを反転する（-0.0は+0.0として扱う）
+			* @tparam Key キーの型（整数・浮動小数点数・列挙型）
+			*/
+			template<typename Key, typename = void>
+			struct radix_traits;
+
+			template<typename Key>
+			struct radix_traits<Key, std::enable_if_t<std::is_integral_v<Key>>> {
+				using key_type = std::make_unsigned_t<std::conditional_t<std::is_same_v<Key, bool>, unsigned char, Key>>;
+
+				static constexpr auto encode(Key key) noexcept -> key_type {
+					if constexpr (std::is_signed_v<Key>) {
+						return static_cast<key_type>(static_cast<key_type>(key) ^ (key_type(1) << (sizeof(key_type) * 8 - 1)));
+					}
+					else {
+						return static_cast<key_type>(key);
+					}
+				}
+			};
+
+			template<typename Key>
+			struct radix_traits<Key, std::enable_if_t<std::is_enum_v<Key>>> {
+				using underlying_traits = radix_traits<std::underlying_type_t<Key>>;
+				using key_type = typename underlying_traits::key_type;
+
+				static constexpr auto encode(Key key) noexcept -> key_type {
+					return underlying_traits::encode(static_cast<std::underlying_type_t<Key>>(key));
+				}
+			};
+
+			template<typename Key>
+			struct radix_traits<Key, std::enable_if_t<std::is_floating_point_v<Key>>> {
+				static_assert(std::numeric_limits<Key>::is_iec559 && (sizeof(Key) == 4 || sizeof(Key) == 8), "Only IEEE-754 float and double keys are supported.");
+
+				using key_type = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+
+				static auto encode(Key key) noexcept -> key_type {
+					constexpr auto sign_bit = key_type(1) << (sizeof(key_type) * 8 - 1);
+
+					//-0.0と+0.0は比較では等しいので、同じキーにする（安定ソートで入力順を保つため）
+					const Key normalized = (key == Key(0)) ? Key(0) : key;
+
+					key_type bits;
+					std::memcpy(&bits, &normalized, sizeof(key_type));
+
+					return (bits & sign_bit) ? key_type(~bits) : key_type(bits | sign_bit);
+				}
+			};
+
+			/**
+			* @brief 要素を射影して基数ソート用の符号なし整数キーへ変換する
+			* @detail 降順（std::greater）の時はキーのビットを反転する
+			*/
+			template<typename Iterator, typename Compare, typename Projection>
+			struct radix_key_encoder {
+				using projected_type = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<const Projection&, typename std::iterator_traits<Iterator>::reference>>>;
+				using traits = radix_traits<projected_type>;
+				using key_type = typename traits::key_type;
+
+				static_assert(is_standard_compare_v<Compare, typename std::iterator_traits<Iterator>::value_type> || is_standard_compare_v<Compare, projected_type>, "Radix sort supports only std::less or std::greater.");
+
+				//降順か
+				static constexpr bool descending = std::disjunction_v<
+					std::is_same<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<typename std::iterator_traits<Iterator>::value_type>>,
+					std::is_same<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<projected_type>>,
+					std::is_same<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<>>
+				>;
+
+				const Projection& proj;
+
+				template<typename T>
+				auto operator()(T&& value) const -> key_type {
+					const auto key = traits::encode(std::invoke(proj, std::forward<T>(value)));
+					if constexpr (descending) {
+						return key_type(~key);
+					}
+					else {
+						return key;
+					}
+				}
+			};
+
+			/**
+			* @brief キーのpass番目（下位から）のバイトを取り出す
+			*/
+			template<typename Key>
+			constexpr auto radix_digit(Key key, std::size_t pass) noexcept -> std::size_t {
+				return std::size_t((key >> (pass * 8)) & 0xFF);
+			}
+
+			/**
+			* @brief これ以下の要素数では基数ソートせずに挿入ソートする
+			*/
+			inline constexpr std::size_t radix_insertion_sort_threshold = 32;
+
+			/**
+			* @brief 変換したキーで比較する挿入ソート（安定）
+			*/
+			template<typename RandomAccessIterator, typename KeyEncoder>
+			void radix_insertion_sort(RandomAccessIterator begin, RandomAccessIterator end, const KeyEncoder& encode) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				if (begin == end) return;
+
+				for (auto current = begin + 1; current != end; ++current) {
+					const auto key = encode(*current);
+
+					//正順であれば次へ
+					if (encode(*(current - 1)) <= key) continue;
+
+					value_t tmp = std::move(*current);
+					auto sift = current;
+
+					//挿入位置を探す
+					do {
+						*sift = std::move(*(sift - 1));
+						--sift;
+					} while (sift != begin && key < encode(*(sift - 1)));
+
+					*sift = std::move(tmp);
+				}
+			}
+
+			/**
+			* @brief アメリカンフラッグソートの本体
+			* @param byte 分配に使うバイト位置（上位から処理する）
+			*/
+			template<typename RandomAccessIterator, typename KeyEncoder>
+			void american_flag_sort_impl(RandomAccessIterator begin, RandomAccessIterator end, const KeyEncoder& encode, std::size_t byte) {
+				SORT_COLLECTION_INSTRUMENT_RECURSION();
+
+				const auto N = std::size_t(end - begin);
+
+				while (true) {
+					//少なければ挿入ソート
+					if (N <= radix_insertion_sort_threshold) {
+						radix_insertion_sort(begin, end, encode);
+						return;
+					}
+
+					//この桁のヒストグラム
+					std::array<std::size_t, 256> count{};
+					for (auto it = begin; it != end; ++it) {
+						++count[radix_digit(encode(*it), byte)];
+					}
+
+					//全要素がこの桁で同じ値なら次の桁へ
+					if (count[radix_digit(encode(*begin), byte)] == N) {
+						if (byte == 0) return;
+						--byte;
+						continue;
+					}
+
+					//各値の区間の先頭と末尾
+					std::array<std::size_t, 256> heads{}, tails{};
+					std::size_t offset = 0;
+					for (std::size_t d = 0; d < 256; ++d) {
+						heads[d] = offset;
+						offset += count[d];
+						tails[d] = offset;
+					}
+
+					//各区間の先頭から、属する区間へ要素を巡回的に入れ替える
+					for (std::size_t d = 0; d < 256; ++d) {
+						while (heads[d] < tails[d]) {
+							const auto digit = radix_digit(encode(begin[heads[d]]), byte);
+							if (digit == d) {
+								++heads[d];
+							}
+							else {
+								std::iter_swap(begin + heads[d], begin + heads[digit]);
+								++heads[digit];
+							}
+						}
+					}
+
+					if (byte == 0) return;
+
+					//各区間を次の桁で再帰的にソート
+					std::size_t first = 0;
+					for (std::size_t d = 0; d < 256; ++d) {
+						if (1 < count[d]) {
+							american_flag_sort_impl(begin + first, begin + (first + count[d]), encode, byte - 1);
+						}
+						first += count[d];
+					}
+
+					return;
+				}
+			}
+
+			/**
+			* @brief RandomAccessIteratorがメモリ上で連続した要素を指すかを判定する
+			* @detail ポインタとstd::vectorのイテレータのみを対象とする
+			* @tparam Iterator 判定するイテレータ型
+			*/
+			template<typename Iterator, typename = void>
+			inline constexpr bool is_contiguous_iterator_v = std::is_pointer_v<Iterator>;
+
+			template<typename Iterator>
+			inline constexpr bool is_contiguous_iterator_v<Iterator, std::enable_if_t<!std::is_pointer_v<Iterator> && !std::is_same_v<typename std::iterator_traits<Iterator>::value_type, bool>>>
+				= std::is_same_v<Iterator, typename std::vector<typename std::iterator_traits<Iterator>::value_type>::iterator>;
+
+			/**
+			* @brief SIMD命令によるソーティングネットワーク
+			* @detail 32bit整数・floatを標準の比較ファンクタで並べる時に、小さい範囲のソートとマージに使用する
+			* @detail 使用する命令セット（AVX2, SSE4.1）は実行時にCPUを調べて選ぶ。使えなければスカラ実装を使う
+			*/
+			namespace simd {
+
+				/**
+				* @brief 使用する命令セット
+				*/
+				enum class instruction_set {
+					scalar,
+					sse41,
+					avx2,
+				};
+
+				/**
+				* @brief 実行中のCPUで使える命令セットを調べる
+				*/
+				inline auto detect_instruction_set() noexcept -> instruction_set {
+#if defined(SORT_COLLECTION_SIMD_X86)
+#if defined(_MSC_VER)
+					int info[4]{};
+					__cpuid(info, 0);
+					const int max_leaf = info[0];
+
+					__cpuid(info, 1);
+					const bool sse41 = (info[2] & (1 << 19)) != 0;
+					const bool osxsave = (info[2] & (1 << 27)) != 0;
+					const bool avx = (info[2] & (1 << 28)) != 0;
+
+					bool avx2 = false;
+					if (7 <= max_leaf && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+						__cpuidex(info, 7, 0);
+						avx2 = (info[1] & (1 << 5)) != 0;
+					}
+
+					if (avx2) return instruction_set::avx2;
+					if (sse41) return instruction_set::sse41;
+#else
+					__builtin_cpu_init();
+					if (__builtin_cpu_supports("avx2")) return instruction_set::avx2;
+					if (__builtin_cpu_supports("sse4.1")) return instruction_set::sse41;
+#endif
+#endif
+					return instruction_set::scalar;
+				}
+
+				/**
+				* @brief 使用する命令セット（最初の呼び出しで決定する）
+				*/
+				inline auto current_instruction_set() noexcept -> instruction_set {
+					static const auto isa = detect_instruction_set();
+					return isa;
+				}
+
+				/**
+				* @brief カーネルでソートできる要素型か
+				*/
+				template<typename T>
+				inline constexpr bool is_kernel_type_v = std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t> || std::is_same_v<T, float>;
+
+				/**
+				* @brief カーネルを使える（イテレータ・要素型・比較ファンクタの）組み合わせか
+				* @tparam RequireStable 安定性が必要なアルゴリズムか（floatは同値の-0.0と+0.0の順序を保たないので除く）
+				*/
+#if defined(SORT_COLLECTION_DISABLE_SIMD)
+				template<typename Iterator, typename Compare, bool RequireStable>
+				inline constexpr bool is_enabled_v = false;
+#else
+				template<typename Iterator, typename Compare, bool RequireStable, typename T = typename std::iterator_traits<Iterator>::value_type>
+				inline constexpr bool is_enabled_v = is_kernel_type_v<T> && is_contiguous_iterator_v<Iterator> && is_standard_compare_v<Compare, T> && (RequireStable == false || std::is_integral_v<T>);
+#endif
+
+
+				/**
+				* @brief 降順（std::greater）か
+				*/
+				template<typename Compare, typename T>
+				inline constexpr bool is_descending_v = std::is_same_v<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<T>> || std::is_same_v<std::remove_cv_t<std::remove_reference_t<Compare>>, std::greater<>>;
+
+				/**
+				* @brief sort_small()で扱える最大の要素数
+				*/
+				inline constexpr std::size_t small_sort_size = 16;
+
+				/**
+				* @brief sort_small()で末尾を埋める番兵（どの値よりも後に並ぶ値）
+				*/
+				template<typename T, bool Descending>
+				constexpr auto sentinel() noexcept -> T {
+					if constexpr (std::numeric_limits<T>::has_infinity) {
+						return Descending ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+					}
+					else {
+						return Descending ? (std::numeric_limits<T>::min)() : (std::numeric_limits<T>::max)();
+					}
+				}
+
+				/**
+				* @brief スカラ実装
+				*/
+				template<typename T, bool Descending>
+				struct scalar_kernel {
+
+					static auto before(T lhs, T rhs) noexcept -> bool {
+						return Descending ? (rhs < lhs) : (lhs < rhs);
+					}
+
+					static void sort_small(T* data, std::size_t n) noexcept {
+						for (std::size_t i = 1; i < n; ++i) {
+							const T tmp = data[i];
+							std::size_t j = i;
+							for (; 0 < j && before(tmp, data[j - 1]); --j) data[j] = data[j - 1];
+							data[j] = tmp;
+						}
+					}
+
+					/**
+					* @brief 3つの整列済み列をマージする（ベクトル化したマージの残りの処理に使う）
+					*/
+					static void merge3(const T* a, std::size_t na, const T* b, std::size_t nb, const T* c, std::size_t nc, T* out) noexcept {
+						std::size_t i = 0, j = 0, k = 0;
+						while (i < na || j < nb || k < nc) {
+							//a, b, cの先頭のうち最初に来るものを選ぶ（同値はa, b, cの順）
+							int pick = -1;
+							T value{};
+							if (i < na) { pick = 0; value = a[i]; }
+							if (j < nb && (pick < 0 || before(b[j], value))) { pick = 1; value = b[j]; }
+							if (k < nc && (pick < 0 || before(c[k], value))) { pick = 2; value = c[k]; }
+
+							*out++ = value;
+							if (pick == 0) ++i;
+							else if (pick == 1) ++j;
+							else ++k;
+						}
+					}
+
+					/**
+					* @brief 整列済みのaとbをoutへマージする
+					* @detail outはbの直前na要素の位置から始まってもよい（書き込みが読み出しを追い越さない）
+					*/
+					static void merge(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) noexcept {
+						merge3(a, na, b, nb, nullptr, 0, out);
+					}
+				};
+
+#if defined(SORT_COLLECTION_SIMD_X86)
+
+				/**
+				* @brief AVX2による8レーンのバイトニックネットワーク
+				*/
+				template<typename T, bool Descending>
+				struct avx2_kernel {
+					using reg = __m256i;
+
+					static constexpr std::size_t width = 8;
+
+					/**
+					* @brief レーン毎に、先に並ぶ方を選ぶ
+					* @detail 同値の時はrhsを返す。対になるlast(rhs, lhs)と組で使えば、floatの-0.0/+0.0も失われない
+					*/
+					SORT_COLLECTION_TARGET_AVX2 static auto first(reg lhs, reg rhs) noexcept -> reg {
+						if constexpr (std::is_same_v<T, float>) {
+							const auto l = _mm256_castsi256_ps(lhs), r = _mm256_castsi256_ps(rhs);
+							return _mm256_castps_si256(Descending ? _mm256_max_ps(l, r) : _mm256_min_ps(l, r));
+						}
+						else if constexpr (std::is_signed_v<T>) {
+							return Descending ? _mm256_max_epi32(lhs, rhs) : _mm256_min_epi32(lhs, rhs);
+						}
+						else {
+							return Descending ? _mm256_max_epu32(lhs, rhs) : _mm256_min_epu32(lhs, rhs);
+						}
+					}
+
+					/**
+					* @brief レーン毎に、後に並ぶ方を選ぶ（同値の時はrhsを返す）
+					*/
+					SORT_COLLECTION_TARGET_AVX2 static auto last(reg lhs, reg rhs) noexcept -> reg {
+						if constexpr (std::is_same_v<T, float>) {
+							const auto l = _mm256_castsi256_ps(lhs), r = _mm256_castsi256_ps(rhs);
+							return _mm256_castps_si256(Descending ? _mm256_min_ps(l, r) : _mm256_max_ps(l, r));
+						}
+						else if constexpr (std::is_signed_v<T>) {
+							return Descending ? _mm256_min_epi32(lhs, rhs) : _mm256_max_epi32(lhs, rhs);
+						}
+						else {
+							return Descending ? _mm256_min_epu32(lhs, rhs) : _mm256_max_epu32(lhs, rhs);
+						}
+					}
+
+					/**
+					* @brief レジスタ内でShuffleの組を比較交換する（Maskのビットが立つレーンが後になる）
+					*/
+					template<int Shuffle, int Mask>
+					SORT_COLLECTION_TARGET_AVX2 static auto exchange(reg v) noexcept -> reg {
+						const auto t = _mm256_shuffle_epi32(v, Shuffle);
+						return _mm256_blend_epi32(first(v, t), last(v, t), Mask);
+					}
+
+					/**
+					* @brief バイトニック列を整列する
+					*/
+					SORT_COLLECTION_TARGET_AVX2 static auto clean(reg v) noexcept -> reg {
+						const auto t = _mm256_permute2x128_si256(v, v, 0x01);
+						v = _mm256_blend_epi32(first(v, t), last(v, t), 0xF0);
+						v = exchange<_MM_SHUFFLE(1, 0, 3, 2), 0xCC>(v);
+						return exchange<_MM_SHUFFLE(2, 3, 0, 1), 0xAA>(v);
+					}
+
+					/**
+					* @brief レジスタ内の8要素をバイトニックソートする
+					*/
+					SORT_COLLECTION_TARGET_AVX2 static auto sort_reg(reg v) noexcept -> reg {
+						//2要素毎に昇順・降順を交互に
+						v = exchange<_MM_SHUFFLE(2, 3, 0, 1), 0x66>(v);
+						//4要素毎に昇順・降順を交互に
+						v = exchange<_MM_SHUFFLE(1, 0, 3, 2), 0x3C>(v);
+						v = exchange<_MM_SHUFFLE(2, 3, 0, 1), 0x5A>(v);
+						//8要素
+						return clean(v);
+					}
+
+					/**
+					* @brief 整列済みのaとbをマージし、前半8要素をa、後半8要素をbに置く
+					*/
+					SORT_COLLECTION_TARGET_AVX2 static void merge_reg(reg& a, reg& b) noexcept {
+						const auto r = _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+						const auto l = first(a, r);
+						const auto h = last(r, a);
+						a = clean(l);
+						b = clean(h);
+					}
+
+					SORT_COLLECTION_TARGET_AVX2 static auto load(const T* p) noexcept -> reg {
+						return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+					}
+
+					SORT_COLLECTION_TARGET_AVX2 static void store(T* p, reg v) noexcept {
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+					}
+
+					SORT_COLLECTION_TARGET_AVX2 static void sort_small(T* data, std::size_t n) noexcept {
+						//末尾を番兵で埋めて16要素にする
+						alignas(32) T buffer[small_sort_size];
+						std::fill(buffer + n, buffer + small_sort_size, sentinel<T, Descending>());
+						std::copy(data, data + n, buffer);
+
+						auto a = sort_reg(load(buffer));
+						if (n <= width) {
+							store(buffer, a);
+						}
+						else {
+							auto b = sort_reg(load(buffer + width));
+							merge_reg(a, b);
+							store(buffer, a);
+							store(buffer + width, b);
+						}
+
+						std::copy(buffer, buffer + n, data);
+					}
+
+					SORT_COLLECTION_TARGET_AVX2 static void merge(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) noexcept {
+						if (na < width || nb < width) {
+							scalar_kernel<T, Descending>::merge(a, na, b, nb, out);
+							return;
+						}
+
+						auto lo = load(a);
+						auto hi = load(b);
+						std::size_t i = width, j = width;
+
+						merge_reg(lo, hi);
+						store(out, lo);
+						out += width;
+
+						//先頭が先に並ぶ側から8要素読み込み、保持している後半8要素とマージする
+						while (i + width <= na && j + width <= nb) {
+							if (scalar_kernel<T, Descending>::before(b[j], a[i])) {
+								lo = load(b + j);
+								j += width;
+							}
+							else {
+								lo = load(a + i);
+								i += width;
+							}
+							merge_reg(lo, hi);
+							store(out, lo);
+							out += width;
+						}
+
+						//保持している8要素と両方の残りをマージする
+						alignas(32) T rest[width];
+						store(rest, hi);
+						scalar_kernel<T, Descending>::merge3(rest, width, a + i, na - i, b + j, nb - j, out);
+					}
+				};
+
+				/**
+				* @brief SSE4.1による4レーンのバイトニックネットワーク
+				*/
+				template<typename T, bool Descending>
+				struct sse41_kernel {
+					using reg = __m128i;
+
+					static constexpr std::size_t width = 4;
+
+					/**
+					* @brief レーン毎に、先に並ぶ方を選ぶ（同値の時はrhsを返す）
+					*/
+					SORT_COLLECTION_TARGET_SSE41 static auto first(reg lhs, reg rhs) noexcept -> reg {
+						if constexpr (std::is_same_v<T, float>) {
+							const auto l = _mm_castsi128_ps(lhs), r = _mm_castsi128_ps(rhs);
+							return _mm_castps_si128(Descending ? _mm_max_ps(l, r) : _mm_min_ps(l, r));
+						}
+						else if constexpr (std::is_signed_v<T>) {
+							return Descending ? _mm_max_epi32(lhs, rhs) : _mm_min_epi32(lhs, rhs);
+						}
+						else {
+							return Descending ? _mm_max_epu32(lhs, rhs) : _mm_min_epu32(lhs, rhs);
+						}
+					}
+
+					/**
+					* @brief レーン毎に、後に並ぶ方を選ぶ（同値の時はrhsを返す）
+					*/
+					SORT_COLLECTION_TARGET_SSE41 static auto last(reg lhs, reg rhs) noexcept -> reg {
+						if constexpr (std::is_same_v<T, float>) {
+							const auto l = _mm_castsi128_ps(lhs), r = _mm_castsi128_ps(rhs);
+							return _mm_castps_si128(Descending ? _mm_min_ps(l, r) : _mm_max_ps(l, r));
+						}
+						else if constexpr (std::is_signed_v<T>) {
+							return Descending ? _mm_min_epi32(lhs, rhs) : _mm_max_epi32(lhs, rhs);
+						}
+						else {
+							return Descending ? _mm_min_epu32(lhs, rhs) : _mm_max_epu32(lhs, rhs);
+						}
+					}
+
+					/**
+					* @brief レジスタ内でShuffleの組を比較交換する（Maskのビットが立つレーンが後になる）
+					*/
+					template<int Shuffle, int Mask>
+					SORT_COLLECTION_TARGET_SSE41 static auto exchange(reg v) noexcept -> reg {
+						//32bitレーンのマスクを16bitレーンのマスクへ広げる
+						constexpr int mask16 = ((Mask & 1) ? 0x03 : 0) | ((Mask & 2) ? 0x0C : 0) | ((Mask & 4) ? 0x30 : 0) | ((Mask & 8) ? 0xC0 : 0);
+
+						const auto t = _mm_shuffle_epi32(v, Shuffle);
+						return _mm_blend_epi16(first(v, t), last(v, t), mask16);
+					}
+
+					/**
+					* @brief バイトニック列を整列する
+					*/
+					SORT_COLLECTION_TARGET_SSE41 static auto clean(reg v) noexcept -> reg {
+						v = exchange<_MM_SHUFFLE(1, 0, 3, 2), 0xC>(v);
+						return exchange<_MM_SHUFFLE(2, 3, 0, 1), 0xA>(v);
+					}
+
+					/**
+					* @brief レジスタ内の4要素をバイトニックソートする
+					*/
+					SORT_COLLECTION_TARGET_SSE41 static auto sort_reg(reg v) noexcept -> reg {
+						//2要素毎に昇順・降順を交互に
+						v = exchange<_MM_SHUFFLE(2, 3, 0, 1), 0x6>(v);
+						//4要素
+						return clean(v);
+					}
+
+					SORT_COLLECTION_TARGET_SSE41 static auto reverse(reg v) noexcept -> reg {
+						return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+					}
+
+					/**
+					* @brief レジスタ間で比較交換する
+					*/
+					SORT_COLLECTION_TARGET_SSE41 static void exchange_reg(reg& a, reg& b) noexcept {
+						const auto l = first(a, b);
+						const auto h = last(b, a);
+						a = l;
+						b = h;
+					}
+
+					/**
+					* @brief 整列済みのaとbをマージし、前半4要素をa、後半4要素をbに置く
+					*/
+					SORT_COLLECTION_TARGET_SSE41 static void merge_reg(reg& a, reg& b) noexcept {
+						b = reverse(b);
+						exchange_reg(a, b);
+						a = clean(a);
+						b = clean(b);
+					}
+
+					SORT_COLLECTION_TARGET_SSE41 static auto load(const T* p) noexcept -> reg {
+						return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+					}
+
+					SORT_COLLECTION_TARGET_SSE41 static void store(T* p, reg v) noexcept {
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+					}
+
+					SORT_COLLECTION_TARGET_SSE41 static void sort_small(T* data, std::size_t n) noexcept {
+						//末尾を番兵で埋めて16要素にする
+						alignas(16) T buffer[small_sort_size];
+						std::fill(buffer + n, buffer + small_sort_size, sentinel<T, Descending>());
+						std::copy(data, data + n, buffer);
+
+						reg v[4];
+						for (std::size_t i = 0; i < 4; ++i) v[i] = sort_reg(load(buffer + i * width));
+
+						//4要素の列を2つずつマージして8要素の列を2つ作る
+						merge_reg(v[0], v[1]);
+						merge_reg(v[2], v[3]);
+
+						//8要素の列同士のマージ（後ろの列を反転してバイトニック列にする）
+						const auto r2 = reverse(v[3]);
+						const auto r3 = reverse(v[2]);
+						v[2] = r2;
+						v[3] = r3;
+						exchange_reg(v[0], v[2]);
+						exchange_reg(v[1], v[3]);
+						exchange_reg(v[0], v[1]);
+						exchange_reg(v[2], v[3]);
+						for (auto& r : v) r = clean(r);
+
+						for (std::size_t i = 0; i < 4; ++i) store(buffer + i * width, v[i]);
+						std::copy(buffer, buffer + n, data);
+					}
+
+					SORT_COLLECTION_TARGET_SSE41 static void merge(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) noexcept {
+						if (na < width || nb < width) {
+							scalar_kernel<T, Descending>::merge(a, na, b, nb, out);
+							return;
+						}
+
+						auto lo = load(a);
+						auto hi = load(b);
+						std::size_t i = width, j = width;
+
+						merge_reg(lo, hi);
+						store(out, lo);
+						out += width;
+
+						//先頭が先に並ぶ側から4要素読み込み、保持している後半4要素とマージする
+						while (i + width <= na && j + width <= nb) {
+							if (scalar_kernel<T, Descending>::before(b[j], a[i])) {
+								lo = load(b + j);
+								j += width;
+							}
+							else {
+								lo = load(a + i);
+								i += width;
+							}
+							merge_reg(lo, hi);
+							store(out, lo);
+							out += width;
+						}
+
+						//保持している4要素と両方の残りをマージする
+						alignas(16) T rest[width];
+						store(rest, hi);
+						scalar_kernel<T, Descending>::merge3(rest, width, a + i, na - i, b + j, nb - j, out);
+					}
+				};
+
+#endif
+
+				/**
+				* @brief 実行時に選んだ命令セットのカーネルを呼び出す
+				*/
+				template<typename T, bool Descending>
+				struct kernel {
+
+					/**
+					* @brief small_sort_size要素以下の範囲をソートする
+					*/
+					static void sort_small(T* data, std::size_t n) noexcept {
+						switch (current_instruction_set()) {
+#if defined(SORT_COLLECTION_SIMD_X86)
+						case instruction_set::avx2:
+							avx2_kernel<T, Descending>::sort_small(data, n);
+							return;
+						case instruction_set::sse41:
+							sse41_kernel<T, Descending>::sort_small(data, n);
+							return;
+#endif
+						default:
+							scalar_kernel<T, Descending>::sort_small(data, n);
+							return;
+						}
+					}
+
+					/**
+					* @brief 整列済みのaとbをoutへマージする
+					* @detail outはbの直前na要素の位置から始まってもよい（書き込みが読み出しを追い越さない）
+					*/
+					static void merge(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) noexcept {
+						switch (current_instruction_set()) {
+#if defined(SORT_COLLECTION_SIMD_X86)
+						case instruction_set::avx2:
+							avx2_kernel<T, Descending>::merge(a, na, b, nb, out);
+							return;
+						case instruction_set::sse41:
+							sse41_kernel<T, Descending>::merge(a, na, b, nb, out);
+							return;
+#endif
+						default:
+							scalar_kernel<T, Descending>::merge(a, na, b, nb, out);
+							return;
+						}
+					}
+				};
+
+				/**
+				* @brief イテレータと比較ファンクタに対応するカーネル
+				*/
+				template<typename Iterator, typename Compare>
+				using kernel_for = kernel<typename std::iterator_traits<Iterator>::value_type, is_descending_v<Compare, typename std::iterator_traits<Iterator>::value_type>>;
+			}
+		}
+
+
+		/**
+		* @brief バブルソート
+		*/
+		struct bubble_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::swap;
+
+
+			template<typename BidirectionalIterator, typename Compare>
+			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
+				if (begin == end) return;
+
+				//入れ替えが行われなかった回数（後ろから見て並んでる個数）を記録
+				int count{};
+
+				//後ろから連続してcount回入れ替えられていなければ（=並んでいる）、その分後ろを減らす（見に行かなくする）
+				for (auto loopend = std::prev(end); loopend != begin; std::advance(loopend, -count)) {
+					count = 0;
+					for (auto current = begin; current != loopend; ++current) {
+						if (detail::compare_and_swap(std::next(current), current,comp) == false)++count;
+						else count = 0;
+					}
+					if (count == 0) ++count;
+				}
+			}
+
+			template<typename BidirectionalIterator, typename Compare>
+			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+		};
+
+		/**
+		* @brief シェイカーソート
+		*/
+		struct shaker_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::swap;
+			
+			template<typename BidirectionalIterator, typename Compare>
+			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
+				if (begin == end) return;
+				
+				//左端と右端
+				auto far_left = begin;
+				auto far_right = std::prev(end);
+				//最後に入れ替えが起きた場所
+				auto last_swap = begin;
+
+				while (far_left != far_right)
+				{
+					//右から左
+					for (auto current = far_left; current != far_right; ++current) {
+						if (detail::compare_and_swap(std::next(current), current, comp) == true)last_swap = current;
+					}
+
+					if (far_left == last_swap) return;
+
+					//右端狭める
+					far_right = last_swap;
+
+					//左から右
+					for (auto current = far_right; current != far_left; --current) {
+						if (detail::compare_and_swap(current, std::prev(current), comp) == true)last_swap = current;
+					}
+
+					//左端狭める
+					far_left = last_swap;
+				}
+			}
+
+			template<typename BidirectionalIterator, typename Compare>
+			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+		};
+
+		/**
+		* @brief シェルソート・コムソートの間隔列
+		* @detail 各ポリシーは1から始まる昇順の間隔の表gapsを持つ。表はコンパイル時に生成する
+		*/
+		namespace gap_sequence {
+
+			namespace detail {
+
+				//表に入れる間隔の上限
+				inline constexpr std::size_t limit = std::numeric_limits<std::size_t>::max() / 4;
+
+				/**
+				* @brief 1から始めて漸化式nextをk回適用した間隔
+				* @detail limitを超えたらそこで止める（h <= limitの間はnext(h)が桁あふれしないこと）
+				*/
+				template<typename Next>
+				constexpr auto iterate(Next next, std::size_t k) -> std::size_t {
+					std::size_t h = 1;
+					for (; k != 0 && h <= limit; --k) h = next(h);
+					return h;
+				}
+
+				/**
+				* @brief k番目の間隔を与える関数から、limit以下の間隔の個数を求める
+				*/
+				constexpr auto count(std::size_t(*term)(std::size_t)) -> std::size_t {
+					std::size_t n = 0;
+					while (term(n) <= limit) ++n;
+					return n;
+				}
+
+				/**
+				* @brief k番目の間隔を与える関数から表を作る
+				*/
+				template<std::size_t N>
+				constexpr auto make_table(std::size_t(*term)(std::size_t)) -> std::array<std::size_t, N> {
+					std::array<std::size_t, N> gaps{};
+					for (std::size_t k = 0; k < N; ++k) gaps[k] = term(k);
+					return gaps;
+				}
+
+				//3h + 1
+				constexpr auto knuth_term(std::size_t k) -> std::size_t {
+					return iterate([](std::size_t h) { return 3 * h + 1; }, k);
+				}
+
+				//実験で求めた9項の後を2.25倍で延長する
+				constexpr auto ciura_term(std::size_t k) -> std::size_t {
+					constexpr std::size_t base[] = { 1, 4, 10, 23, 57, 132, 301, 701, 1750 };
+					if (k < std::size(base)) return base[k];
+
+					std::size_t h = base[std::size(base) - 1];
+					for (k -= std::size(base) - 1; k != 0 && h <= limit; --k) h = 2 * h + h / 4;
+					return h;
+				}
+
+				//ceil((9^k - 4^k) / (5 * 4^(k-1)))（k >= 1）
+				constexpr auto tokuda_term(std::size_t k) -> std::size_t {
+					double pow9 = 9.0, pow4 = 4.0;
+					for (; k != 0; --k) {
+						pow9 *= 9.0;
+						pow4 *= 4.0;
+					}
+
+					const double h = (pow9 - pow4) / (5.0 * pow4 / 4.0);
+					if (double(limit) < h) return limit + 1;
+
+					const auto truncated = std::size_t(h);
+					return (double(truncated) < h) ? truncated + 1 : truncated;
+				}
+
+				//1, 4^k + 3 * 2^(k-1) + 1
+				constexpr auto sedgewick_term(std::size_t k) -> std::size_t {
+					if (k == 0) return 1;
+					if (std::size_t(std::numeric_limits<std::size_t>::digits) - 2 <= 2 * k) return limit + 1;
+					return (std::size_t(1) << (2 * k)) + 3 * (std::size_t(1) << (k - 1)) + 1;
+				}
+
+				//ceil(1.3h)
+				constexpr auto comb11_term(std::size_t k) -> std::size_t {
+					return iterate([](std::size_t h) { return h + (3 * h + 9) / 10; }, k);
+				}
+
+				/**
+				* @brief limit以下の2^p 3^qの個数
+				*/
+				constexpr auto count_pratt() -> std::size_t {
+					std::size_t n = 0;
+					for (std::size_t pow3 = 1; pow3 <= limit; pow3 = (pow3 <= limit / 3) ? pow3 * 3 : limit + 1) {
+						for (std::size_t h = pow3; h <= limit; h = (h <= limit / 2) ? h * 2 : limit + 1) ++n;
+					}
+					return n;
+				}
+
+				/**
+				* @brief 2^p 3^qを小さい順に並べた表（2倍と3倍の列をマージして作る）
+				*/
+				template<std::size_t N>
+				constexpr auto make_pratt() -> std::array<std::size_t, N> {
+					std::array<std::size_t, N> gaps{};
+					gaps[0] = 1;
+					std::size_t i2 = 0, i3 = 0;
+					for (std::size_t k = 1; k < N; ++k) {
+						const auto by2 = gaps[i2] * 2, by3 = gaps[i3] * 3;
+						gaps[k] = (by2 < by3) ? by2 : by3;
+						if (by2 == gaps[k]) ++i2;
+						if (by3 == gaps[k]) ++i3;
+					}
+					return gaps;
+				}
+			}
+
+			/**
+			* @brief Knuth（1, 4, 13, 40, ...）
+			*/
+			struct knuth {
+				static constexpr auto gaps = detail::make_table<detail::count(detail::knuth_term)>(detail::knuth_term);
+			};
+
+			/**
+			* @brief Ciura（1, 4, 10, 23, 57, 132, 301, 701, 1750の後を2.25倍で延長）
+			*/
+			struct ciura {
+				static constexpr auto gaps = detail::make_table<detail::count(detail::ciura_term)>(detail::ciura_term);
+			};
+
+			/**
+			* @brief Tokuda（1, 4, 9, 20, 46, 103, ...）
+			*/
+			struct tokuda {
+				static constexpr auto gaps = detail::make_table<detail::count(detail::tokuda_term)>(detail::tokuda_term);
+			};
+
+			/**
+			* @brief Sedgewick 1986（1, 8, 23, 77, 281, ...）
+			*/
+			struct sedgewick {
+				static constexpr auto gaps = detail::make_table<detail::count(detail::sedgewick_term)>(detail::sedgewick_term);
+			};
+
+			/**
+			* @brief Pratt（2^p 3^q、比較回数はO(N log^2 N)だが間隔の数が多い）
+			*/
+			struct pratt {
+				static constexpr auto gaps = detail::make_pratt<detail::count_pratt()>();
+			};
+
+			/**
+			* @brief 1.3倍ずつ（9と10を通らないComb11）。コムソートの既定
+			*/
+			struct comb11 {
+				static constexpr auto gaps = detail::make_table<detail::count(detail::comb11_term)>(detail::comb11_term);
+			};
+		}
+
+		/**
+		* @brief コムソート
+		* @detail 間隔列の大きい方から順に間隔hだけ離れた組を比較・交換し、h=1で交換が起きなくなるまで繰り返す
+		* @tparam GapSequence 間隔列（既定はgap_sequence::comb11）
+		*/
+		template<typename GapSequence = gap_sequence::comb11>
+		struct basic_comb_sort {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::swap;
+
+			template<typename ForwardIterator, typename Compare>
+			static constexpr void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<ForwardIterator>::difference_type;
+
+				const auto& gaps = GapSequence::gaps;
+
+				//要素数
+				const auto N = static_cast<diff_t>(std::distance(begin, end));
+
+				if (N < diff_t(2)) return;
+
+				//N未満の間隔の数（gaps[0] == 1なので1以上）
+				std::size_t k = 0;
+				while (k < gaps.size() && diff_t(gaps[k]) < N) ++k;
+
+				//h=1のとき、交換が行われなくなるまで繰り返す
+				for (;;) {
+					const auto h = diff_t(gaps[k - 1]);
+
+					//入れ替えが起きたかどうか
+					bool is_swapped = false;
+
+					//iの位置とi+hの位置を並べて進める（ForwardIteratorでも1回の走査がO(N)で済む）
+					auto current = begin;
+					for (auto next = std::next(begin, h); next != end; ++current, ++next) {
+						//next < current の時入れ替え
+						//一回でもtrueが帰ればis_swappedは以降trueとなる（条件分岐回避のため、趣味）
+						is_swapped |= detail::compare_and_swap(next, current, comp);
+					}
+
+					if (1 < k) --k;
+					//h=1の走査で交換が無ければ整列済み
+					else if (is_swapped == false) break;
+				}
+			}
+
+			template<typename ForwardIterator, typename Compare>
+			constexpr void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+		};
+
+		/**
+		* @brief コムソート（コムソート11）
+		*/
+		using comb_sort = basic_comb_sort<>;
+
+
+		/**
+		* @brief ノームソート
+		*/
+		struct gnome_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::swap;
+
+			template<typename BidirectionalIterator, typename Compare>
+			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
+				if (begin == end) return;
+
+				//終了位置
+				auto far_right = std::prev(end);
+				//注目位置
+				auto current = begin;
+
+				while (current != far_right)
+				{
+					//current < current + 1　次の要素と比較
+					if (detail::compare_and_swap(std::next(current), current, comp) == true) {
+						//入れ替えが起きていたら
+						if (current != begin) {
+							//一つ戻って比較
+							--current;
+						}
+						else {
+							//左端の時は進む
+							++current;
+						}
+					}
+					else {
+						//入れ替えが起きなかったら
+						++current;
+					}
+				}
+			}
+
+			template<typename BidirectionalIterator, typename Compare>
+			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+		};
+
+		/**
+		* @brief 選択ソート
+		*/
+		struct selection_sort {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::select;
+
+			template<typename ForwardIterator, typename Compare>
+			static constexpr void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) {
+				if (begin == end) return;
+
+				//範囲の右端
+				auto far_right = std::next(begin, std::distance(begin, end) - 1);
+
+				if (begin == far_right) return;
+
+				for (auto current = begin; current != far_right; ++current) {
+					//一番小さい要素を探す
+					auto min_it = std::min_element(current, end, comp);
+					//それがcurrentがでなければ入れ替え
+					if (min_it != current) detail::iter_swap(min_it, current);
+				}
+			}
+
+			template<typename ForwardIterator, typename Compare>
+			constexpr void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+		};
+
+		struct insertion_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::insert;
+
+			template<typename BidirectionalIterator, typename Compare>
+			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
+				using value_t = typename std::iterator_traits<BidirectionalIterator>::value_type;
+
+				if (begin == end) return;
+
+				//2番目の要素から
+				for (auto current = std::next(begin); current != end; ++current) {
+					//一つ左の要素
+					auto prev = std::prev(current);
+
+					//正順であれば次へ（同値の要素は動かさない）
+					if (comp(*current, *prev) == false) continue;
+
+					//currentの要素を退避
+					value_t tmp = std::move(*current);
+
+					//挿入位置
+					auto hole = current;
+
+					//挿入位置を探す
+					do {
+						*hole = std::move(*prev);
+						hole = prev;
+						//prevが先頭に達したら終わり
+						if (prev == begin) break;
+						--prev;
+						//tmp < prevである間ループ
+					} while (comp(tmp, *prev));
+					//挿入
+					*hole = std::move(tmp);
+				}
+			}
+
+			template<typename BidirectionalIterator, typename Compare>
+			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+		};
+
+		/**
+		* @brief シェルソート
+		* @detail 間隔列の大きい方から順に、間隔hごとの挿入ソート（h整列）を行う
+		* @tparam GapSequence 間隔列（既定はgap_sequence::ciura）
+		*/
+		template<typename GapSequence = gap_sequence::ciura>
+		struct basic_shell_sort {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::insert;
+
+			template<typename BidirectionalIterator, typename Compare>
+			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<BidirectionalIterator>::difference_type;
+				//要素の型
+				using value_t = typename std::iterator_traits<BidirectionalIterator>::value_type;
+
+				const auto& gaps = GapSequence::gaps;
+
+				//要素数
+				const auto N = static_cast<diff_t>(std::distance(begin, end));
+
+				if (N < diff_t(2)) return;
+
+				//N未満の間隔の数（少なくともh=1で挿入ソートする）
+				std::size_t k = 0;
+				while (k < gaps.size() && diff_t(gaps[k]) < N) ++k;
+
+				while (k-- != 0) {
+					const auto h = diff_t(gaps[k]);
+
+					//注目要素とそのh個前
+					auto current = std::next(begin, h);
+					auto head = begin;
+
+					for (auto index = h; current != end; ++index, ++current, ++head) {
+						//正順であれば次へ
+						if (comp(*current, *head) == false) continue;
+
+						//currentの要素を退避
+						value_t tmp = std::move(*current);
+
+						//挿入位置とそのh個前、prevの位置
+						auto hole = current;
+						auto prev = head;
+						auto prev_index = index - h;
+
+						//挿入位置を探す
+						do {
+							*hole = std::move(*prev);
+							hole = prev;
+							//h個前が無ければ終わり
+							if (prev_index < h) break;
+							prev_index -= h;
+							std::advance(prev, -h);
+							//tmp < prevである間ループ
+						} while (comp(tmp, *prev));
+						//挿入
+						*hole = std::move(tmp);
+					}
+				}
+			}
+
+			template<typename BidirectionalIterator, typename Compare>
+			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+		};
+
+		/**
+		* @brief シェルソート（Ciuraの間隔列）
+		*/
+		using shell_sort = basic_shell_sort<>;
+
+		namespace detail {
+
+			/**
+			* @brief ソーティングネットワークの比較器（lhs < rhsの位置の組）
+			* @detail C++17のstd::pairは代入がconstexprでないので、定数式の中で配列へ詰めるために使う
+			*/
+			struct comparator {
+				std::size_t lhs;
+				std::size_t rhs;
+			};
+
+			/**
+			* @brief Batcherのマージ交換法（Knuth 5.2.2 Algorithm M）の比較器を順に列挙する
+			* @param N 要素数
+			* @param f 比較器の位置の組(i, j)（i < j）を受け取る関数
+			*/
+			template<typename F>
+			constexpr void merge_exchange_network(std::size_t N, F&& f) {
+				if (N < 2) return;
+
+				//2^t >= Nとなる最小のt
+				std::size_t t = 0;
+				while ((std::size_t(1) << t) < N) ++t;
+
+				for (std::size_t p = std::size_t(1) << (t - 1); 0 < p; p >>= 1) {
+					std::size_t q = std::size_t(1) << (t - 1);
+					std::size_t r = 0;
+					std::size_t d = p;
+					while (true) {
+						for (std::size_t i = 0; i + d < N; ++i) {
+							if ((i & p) == r) f(i, i + d);
+						}
+						if (q == p) break;
+						d = q - p;
+						q >>= 1;
+						r = p;
+					}
+				}
+			}
+
+			/**
+			* @brief 要素数Nのマージ交換ネットワークを配列として作る
+			*/
+			template<std::size_t N>
+			constexpr auto make_merge_exchange_network() {
+				constexpr auto size = [] {
+					std::size_t count = 0;
+					merge_exchange_network(N, [&count](std::size_t, std::size_t) { ++count; });
+					return count;
+				}();
+
+				std::array<comparator, size> network{};
+				std::size_t k = 0;
+				merge_exchange_network(N, [&network, &k](std::size_t i, std::size_t j) { network[k++] = comparator{ i, j }; });
+				return network;
+			}
+		}
+
+		/**
+		* @brief ソーティングネットワーク
+		* @detail 要素数Nに対するBatcherのマージ交換ネットワークをコンパイル時に作り、ループなしに展開した比較交換で並べ替える
+		* @detail 比較器の数はN <= 8で最適、それより大きくても最適に近い（N = 16で63個（最適は60個）、N = 32で191個（既知の最良は185個））
+		* @detail 比較の結果に依らず同じ位置の組を比べるので分岐予測を外さず、算術型は分岐しないcompare_and_swap()になる
+		* @tparam N 要素数（展開するコード量が増えるので64まで）
+		*/
+		template<std::size_t N>
+		struct network_sort {
+			static_assert(N <= 64, "network_sort is fully unrolled; use another algorithm for larger N.");
+
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::swap;
+
+			/**
+			* @brief 比較器の列
+			*/
+			static constexpr auto network = detail::make_merge_exchange_network<N>();
+
+			/**
+			* @detail 範囲の要素数がNでなければ挿入ソートする
+			*/
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			static constexpr void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) {
+				if (end - begin != static_cast<typename std::iterator_traits<RandomAccessIterator>::difference_type>(N)) {
+					insertion_sort::sort(begin, end, comp);
+					return;
+				}
+				apply(begin, comp, std::make_index_sequence<network.size()>{});
+			}
+
+			template<typename T, typename Compare = std::less<T>>
+			static constexpr void sort(std::array<T, N>& array, Compare&& comp = Compare{}) {
+				apply(array.begin(), comp, std::make_index_sequence<network.size()>{});
+			}
+
+			template<typename T, typename Compare = std::less<T>>
+			static constexpr void sort(T(&array)[N], Compare&& comp = Compare{}) {
+				apply(std::begin(array), comp, std::make_index_sequence<network.size()>{});
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			constexpr void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			template<typename RandomAccessIterator, typename Compare, std::size_t... I>
+			static constexpr void apply([[maybe_unused]] RandomAccessIterator begin, [[maybe_unused]] Compare& comp, std::index_sequence<I...>) {
+				(detail::compare_and_swap(begin + network[I].rhs, begin + network[I].lhs, comp), ...);
+			}
+		};
+
+		namespace detail {
+
+			/**
+			* @brief 連結リストをノードの繋ぎ替えだけでマージソートする（ボトムアップ、安定）
+			* @detail 先頭から1ノードずつ取り出し、2^i個ずつのランを持つ桁へ2進数の繰り上がりのようにマージしていく
+			* @detail 要素のムーブやコピーは起こらない。新しく取り出したノードは直近の短いランとだけマージされるので、キャッシュにも優しい
+			* @param list ソートするstd::listかstd::forward_list
+			*/
+			template<typename List, typename Compare>
+			void list_merge_sort(List& list, Compare& comp) {
+				if (list.empty() || std::next(list.begin()) == list.end()) return;
+
+				//桁iには2^i個のランが入る（空もある）
+				List carry(list.get_allocator());
+				std::vector<List> counter;
+
+				while (list.empty() == false) {
+					if constexpr (std::is_same_v<List, std::list<typename List::value_type, typename List::allocator_type>>) {
+						carry.splice(carry.begin(), list, list.begin());
+					}
+					else {
+						carry.splice_after(carry.before_begin(), list, list.before_begin());
+					}
+
+					//空いている桁まで繰り上げる。桁の方が先に並んでいた要素なので、同値ならそちらが前に残る
+					std::size_t digit = 0;
+					for (; digit < counter.size() && counter[digit].empty() == false; ++digit) {
+						counter[digit].merge(carry, std::ref(comp));
+						carry.swap(counter[digit]);
+					}
+					if (digit == counter.size()) counter.emplace_back(list.get_allocator());
+					carry.swap(counter[digit]);
+				}
+
+				//上の桁ほど先に並んでいた要素
+				for (std::size_t digit = 1; digit < counter.size(); ++digit) {
+					counter[digit].merge(counter[digit - 1], std::ref(comp));
+				}
+				list.swap(counter.back());
+			}
+		}
+
+		/**
+		* @brief マージソート
+		* @detail 左側の部分列だけを作業領域へ退避してマージするので、逐次版の作業領域は(N+1)/2要素の未初期化領域で足りる
+		*/
+		struct marge_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::merge;
+
+			template<typename ForwardIterator, typename Compare>
+			static constexpr void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) {
+				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+
+				//作業用メモリ確保
+				workspace<value_t> buffer{};
+
+				//委託
+				sort(begin, end, std::forward<Compare>(comp), buffer);
+			}
+
+			/**
+			* @brief 連結リストをノードの繋ぎ替えでソートする
+			* @detail 要素は動かさず、作業領域も使わないボトムアップのマージソート
+			* @param list ソートするstd::listかstd::forward_list
+			* @param comp 比較に使うファンクタ
+			*/
+			template<typename List, typename Compare = std::less<typename List::value_type>, std::enable_if_t<detail::is_linked_list_v<List>, std::nullptr_t> = nullptr>
+			static void sort(List& list, Compare&& comp = Compare{}) {
+				detail::list_merge_sort(list, comp);
+			}
+
+			/**
+			* @brief 呼び出し側の作業領域を使ってソートする
+			* @detail 容量が足りない場合だけ作業領域を拡張する。同じ作業領域を使い回せば、2回目以降は確保が起きない
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param buffer 作業領域
+			*/
+			template<typename ForwardIterator, typename Compare, typename T, typename Allocator>
+			static void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp, workspace<T, Allocator>& buffer) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<ForwardIterator>::difference_type;
+				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+
+				static_assert(std::is_same_v<T, value_t>, "The element type of workspace must be the value_type of the iterator.");
+
+				//要素数
+				auto N = diff_t(std::distance(begin, end));
+
+				buffer.reserve(workspace_size(std::size_t(N)));
+
+				//委託
+				margesort_impl(begin, end, std::forward<Compare>(comp), buffer.data());
+			}
+
+			/**
+			* @brief メモリリソースから作業領域を確保してソートする
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param resource 作業領域の確保に使うメモリリソース
+			*/
+			template<typename ForwardIterator, typename Compare>
+			static void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp, std::pmr::memory_resource* resource) {
+				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+
+				pmr::workspace<value_t> buffer{ resource };
+
+				sort(begin, end, std::forward<Compare>(comp), buffer);
+			}
+
+			/**
+			* @brief アロケータで作業領域を確保してソートする
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param alloc 作業領域の確保に使うアロケータ（value_typeへrebindして使用する）
+			*/
+			template<typename ForwardIterator, typename Compare, typename Allocator>
+			static void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp, std::allocator_arg_t, const Allocator& alloc) {
+				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+				using alloc_t = typename std::allocator_traits<Allocator>::template rebind_alloc<value_t>;
+
+				workspace<value_t, alloc_t> buffer{ alloc_t(alloc) };
+
+				sort(begin, end, std::forward<Compare>(comp), buffer);
+			}
+
+			template<typename ForwardIterator, typename Compare>
+			constexpr void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+			template<typename ForwardIterator, typename Compare, typename T, typename Allocator>
+			void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp, workspace<T, Allocator>& buffer) const {
+				sort(begin, end, std::forward<Compare>(comp), buffer);
+			}
+
+			/**
+			* @brief ソート済みの隣接する2つの範囲をマージする
+			* @detail 短い方の部分列だけを作業領域へ退避する。右側の方が短い時は末尾から逆向きにマージする
+			* @detail 同値の要素は左側が先に並ぶ
+			* @param begin 左側の範囲の初め
+			* @param center 左側の範囲の終わり（右側の範囲の初め）
+			* @param end 右側の範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param buffer 作業領域（短い方の要素数まで拡張される）
+			*/
+			template<typename BidirectionalIterator, typename Compare, typename T, typename Allocator>
+			static void merge(BidirectionalIterator begin, BidirectionalIterator center, BidirectionalIterator end, Compare&& comp, workspace<T, Allocator>& buffer) {
+				using value_t = typename std::iterator_traits<BidirectionalIterator>::value_type;
+
+				static_assert(std::is_same_v<T, value_t>, "The element type of workspace must be the value_type of the iterator.");
+
+				const auto left_size = std::size_t(std::distance(begin, center));
+				const auto right_size = std::size_t(std::distance(center, end));
+
+				if (left_size == 0 || right_size == 0) return;
+
+				if (left_size <= right_size) {
+					buffer.reserve(left_size);
+					merge_with_buffer(begin, center, end, comp, buffer.data());
+				}
+				else {
+					buffer.reserve(right_size);
+					merge_with_buffer_backward(begin, center, end, comp, buffer.data());
+				}
+			}
+
+			/**
+			* @brief 逐次版のソートに必要な作業領域の要素数
+			* @param N ソートする要素数
+			*/
+			static constexpr auto workspace_size(std::size_t N) noexcept -> std::size_t {
+				return (N + 1) / 2;
+			}
+
+			/**
+			* @brief 並列版のソートに必要な作業領域の要素数
+			* @param N ソートする要素数
+			*/
+			static constexpr auto parallel_workspace_size(std::size_t N) noexcept -> std::size_t {
+				return N;
+			}
+
+			/**
+			* @brief 並列処理に切り替える要素数の閾値
+			* @detail これより短い部分列は逐次版で処理する。マージの分割単位にも使用する
+			*/
+			static inline std::size_t parallel_cutoff = 1 << 13;
+
+			/**
+			* @brief 実行ポリシーを指定してソートする
+			* @detail 並列ポリシーかつRandomAccessIteratorの時、左右の部分列を並列にソートし、マージもmerge pathで分割して並列に行う
+			* @param policy 実行ポリシー
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			*/
+			template<typename ExecutionPolicy, typename ForwardIterator, typename Compare = detail::default_compare<ForwardIterator>, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+			static void sort(ExecutionPolicy&& policy, ForwardIterator begin, ForwardIterator end, Compare&& comp = Compare{}) {
+				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+
+				//作業用メモリ確保
+				workspace<value_t> buffer{};
+
+				sort(std::forward<ExecutionPolicy>(policy), begin, end, std::forward<Compare>(comp), buffer);
+			}
+
+			/**
+			* @brief 実行ポリシーと呼び出し側の作業領域を指定してソートする
+			* @detail 並列実行時は parallel_workspace_size(N) 要素の作業領域を使用する
+			* @param policy 実行ポリシー
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param buffer 作業領域
+			*/
+			template<typename ExecutionPolicy, typename ForwardIterator, typename Compare, typename T, typename Allocator, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+			static void sort(ExecutionPolicy&&, ForwardIterator begin, ForwardIterator end, Compare&& comp, workspace<T, Allocator>& buffer) {
+				if constexpr (detail::is_parallel_policy_v<ExecutionPolicy> && detail::is_random_access_iterator_v<ForwardIterator>) {
+					//イテレータ間距離の型
+					using diff_t = typename std::iterator_traits<ForwardIterator>::difference_type;
+					using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+
+					static_assert(std::is_same_v<T, value_t>, "The element type of workspace must be the value_type of the iterator.");
+
+					//要素数
+					auto N = diff_t(std::distance(begin, end));
+
+					if (N < diff_t(parallel_cutoff)) {
+						sort(begin, end, std::forward<Compare>(comp), buffer);
+						return;
+					}
+
+					buffer.reserve(parallel_workspace_size(std::size_t(N)));
+
+					parallel_margesort_impl(begin, end, comp, buffer.data(), detail::thread_pool::instance());
+				}
+				else {
+					sort(begin, end, std::forward<Compare>(comp), buffer);
+				}
+			}
+
+			template<typename ExecutionPolicy, typename ForwardIterator, typename Compare = detail::default_compare<ForwardIterator>, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+			void operator()(ExecutionPolicy&& policy, ForwardIterator begin, ForwardIterator end, Compare&& comp = Compare{}) const {
+				sort(std::forward<ExecutionPolicy>(policy), begin, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			template<typename RandomAccessIterator, typename Compare, typename T>
+			static void parallel_margesort_impl(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp, T* workspace, detail::thread_pool& pool) {
+				SORT_COLLECTION_INSTRUMENT_RECURSION();
+
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+				//要素数
+				auto N = diff_t(end - begin);
+
+				if (N < diff_t(parallel_cutoff)) {
+					margesort_impl(begin, end, comp, workspace);
+					return;
+				}
+
+				auto center_index = (N + 1) / 2;
+				auto center = begin + center_index;
+
+				//左右の部分列は作業領域を分けて並列にソート
+				{
+					detail::task_group group{ pool };
+					group.run([&] { parallel_margesort_impl(begin, center, comp, workspace, pool); });
+					parallel_margesort_impl(center, end, comp, workspace + center_index, pool);
+					group.wait();
+				}
+
+				parallel_merge(begin, center, end, comp, workspace, pool);
+			}
+
+			/**
+			* @brief merge pathで出力を等分し、各区間を並列にマージする
+			* @detail [begin, center)と[center, end)を未初期化のworkspaceへ構築しながらマージした後、元の範囲へ戻す
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T>
+			static void parallel_merge(RandomAccessIterator begin, RandomAccessIterator center, RandomAccessIterator end, Compare& comp, T* workspace, detail::thread_pool& pool) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+				const auto left_size = diff_t(center - begin);
+				const auto right_size = diff_t(end - center);
+				const auto N = left_size + right_size;
+
+				//分割数
+				const auto parts = std::max(diff_t(1), std::min(diff_t(pool.concurrency()), N / diff_t(parallel_cutoff)));
+
+				//出力位置diagまでに左側から取られる要素数を二分探索する（同値は左側を先に取る）
+				auto merge_path = [&](diff_t diag) -> diff_t {
+					auto lo = std::max(diff_t(0), diag - right_size);
+					auto hi = std::min(diag, left_size);
+					while (lo < hi) {
+						auto mid = lo + (hi - lo) / 2;
+						if (comp(center[diag - mid - 1], begin[mid]) == false) lo = mid + 1;
+						else hi = mid;
+					}
+					return lo;
+				};
+
+				//マージ中は移動元の要素が変化するので、分割位置は先に全て求めておく
+				std::vector<diff_t> splits(std::size_t(parts + 1));
+				for (auto k = diff_t(0); k <= parts; ++k) {
+					splits[std::size_t(k)] = merge_path(N * k / parts);
+				}
+
+				auto merge_part = [&](diff_t k) {
+					const auto diag_first = N * k / parts;
+					const auto diag_last = N * (k + 1) / parts;
+
+					auto left_head = begin + splits[std::size_t(k)];
+					auto left_last = begin + splits[std::size_t(k + 1)];
+					auto right_head = center + (diag_first - splits[std::size_t(k)]);
+					auto right_last = center + (diag_last - splits[std::size_t(k + 1)]);
+
+					auto out = workspace + diag_first;
+
+					//例外が送出された場合、この区間で構築済みの要素を破棄する
+					struct destroy_guard {
+						T* first;
+						T*& last;
+
+						~destroy_guard() {
+							if (first != nullptr) std::destroy(first, last);
+						}
+					} guard{ out, out };
+
+					while (left_head != left_last && right_head != right_last) {
+						if (comp(*right_head, *left_head)) {
+							::new (static_cast<void*>(out)) T(std::move(*right_head));
+							++right_head;
+						}
+						else {
+							::new (static_cast<void*>(out)) T(std::move(*left_head));
+							++left_head;
+						}
+						++out;
+					}
+					for (; left_head != left_last; ++left_head, ++out) ::new (static_cast<void*>(out)) T(std::move(*left_head));
+					for (; right_head != right_last; ++right_head, ++out) ::new (static_cast<void*>(out)) T(std::move(*right_head));
+
+					guard.first = nullptr;
+				};
+
+				auto move_back_part = [&](diff_t k) {
+					const auto diag_first = N * k / parts;
+					const auto diag_last = N * (k + 1) / parts;
+					std::move(workspace + diag_first, workspace + diag_last, begin + diag_first);
+					std::destroy(workspace + diag_first, workspace + diag_last);
+				};
+
+				auto run_parts = [&](auto& part) {
+					detail::task_group group{ pool };
+					for (auto k = diff_t(1); k < parts; ++k) {
+						group.run([&part, k] { part(k); });
+					}
+					part(diff_t(0));
+					group.wait();
+				};
+
+				//全区間のマージが終わるまで元の範囲へは書き戻せない
+				run_parts(merge_part);
+				run_parts(move_back_part);
+			}
+
+			/**
+			* @brief 左側の部分列を作業領域へ退避し、右側の部分列と元の範囲の先頭からマージする
+			* @detail 書き込み位置は右側の読み出し位置を追い越さないので、作業領域は左側の要素数分の未初期化領域でよい
+			*/
+			template<typename ForwardIterator, typename Compare, typename T>
+			static void merge_with_buffer(ForwardIterator begin, ForwardIterator center, ForwardIterator end, Compare& comp, T* workspace) {
+				if constexpr (detail::simd::is_enabled_v<ForwardIterator, Compare, stable>) {
+					//32bit整数の連続した範囲はSIMDでマージする
+					const auto left_size = std::size_t(center - begin);
+					std::memcpy(workspace, std::addressof(*begin), left_size * sizeof(T));
+					detail::simd::kernel_for<ForwardIterator, Compare>::merge(workspace, left_size, std::addressof(*center), std::size_t(end - center), std::addressof(*begin));
+					return;
+				}
+
+				//左側シーケンスを作業領域へ移動（ここで構築される）
+				T* const buffer_end = std::uninitialized_move(begin, center, workspace);
+
+				//左側の先頭
+				T* left_head = workspace;
+				//右側の先頭
+				auto right_head = center;
+				//書き込み位置
+				auto out = begin;
+
+				//左側の残りを元の範囲へ戻して作業領域を破棄する
+				//例外で抜けた場合も、範囲に抜けが残らないよう同じ処理を行う
+				struct restore_guard {
+					T* workspace;
+					T* buffer_end;
+					T*& left_head;
+					ForwardIterator& out;
+
+					~restore_guard() {
+						std::move(left_head, buffer_end, out);
+						std::destroy(workspace, buffer_end);
+					}
+				} guard{ workspace, buffer_end, left_head, out };
+
+				while (left_head != buffer_end && right_head != end) {
+					//*right_head < *left_head の時だけ右側を取る（同値は左側が先）
+					if (comp(*right_head, *left_head)) {
+						*out = std::move(*right_head);
+						++right_head;
+					}
+					else {
+						*out = std::move(*left_head);
+						++left_head;
+					}
+					++out;
+				}
+				//右側が先に尽きた場合、左側の残りはguardが移動する
+				//左側が先に尽きた場合、右側の残りは既に正しい位置にある
+			}
+
+			/**
+			* @brief 右側の部分列を作業領域へ退避し、左側の部分列と元の範囲の末尾から逆向きにマージする
+			* @detail merge_with_buffer()の向きを逆にしたもの。作業領域は右側の要素数分の未初期化領域でよい
+			*/
+			template<typename BidirectionalIterator, typename Compare, typename T>
+			static void merge_with_buffer_backward(BidirectionalIterator begin, BidirectionalIterator center, BidirectionalIterator end, Compare& comp, T* workspace) {
+				//右側シーケンスを作業領域へ移動（ここで構築される）
+				T* const buffer_end = std::uninitialized_move(center, end, workspace);
+
+				//右側の残りの終わり
+				T* right_tail = buffer_end;
+				//左側の残りの終わり
+				auto left_tail = center;
+				//書き込み位置の終わり
+				auto out = end;
+
+				//右側の残りを元の範囲へ戻して作業領域を破棄する
+				//例外で抜けた場合も、範囲に抜けが残らないよう同じ処理を行う
+				struct restore_guard {
+					T* workspace;
+					T* buffer_end;
+					T*& right_tail;
+					BidirectionalIterator& out;
+
+					~restore_guard() {
+						std::move_backward(workspace, right_tail, out);
+						std::destroy(workspace, buffer_end);
+					}
+				} guard{ workspace, buffer_end, right_tail, out };
+
+				while (right_tail != workspace && left_tail != begin) {
+					auto left_last = std::prev(left_tail);
+
+					//*right_last < *left_last の時だけ左側を取る（同値は右側が後）
+					if (comp(*std::prev(right_tail), *left_last)) {
+						*--out = std::move(*left_last);
+						left_tail = left_last;
+					}
+					else {
+						--right_tail;
+						*--out = std::move(*right_tail);
+					}
+				}
+				//左側が先に尽きた場合、右側の残りはguardが移動する
+				//右側が先に尽きた場合、左側の残りは既に正しい位置にある
+			}
+
+			template<typename ForwardIterator, typename Compare, typename T>
+			static void margesort_impl(ForwardIterator begin, ForwardIterator end, Compare&& comp, T* workspace) {
+				SORT_COLLECTION_INSTRUMENT_RECURSION();
+
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<ForwardIterator>::difference_type;
+
+				//要素数
+				auto N = diff_t(std::distance(begin, end));
+
+				if constexpr (detail::simd::is_enabled_v<ForwardIterator, Compare, stable>) {
+					//小さい範囲はソーティングネットワークで一度にソートする
+					if (diff_t(1) < N && N <= diff_t(detail::simd::small_sort_size)) {
+						detail::simd::kernel_for<ForwardIterator, Compare>::sort_small(std::addressof(*begin), std::size_t(N));
+						return;
+					}
+				}
+
+				if (diff_t(2) < N) {
+					auto center_index = (N + 1) / 2;
+					auto center = std::next(begin, center_index);
+
+					//左側シーケンスをソート
+					margesort_impl(begin, center, comp, workspace);
+					//右側シーケンスをソート
+					margesort_impl(center, end, comp, workspace);
+
+					merge_with_buffer(begin, center, end, comp, workspace);
+				}
+				else if (N == diff_t(2)) {
+					detail::compare_and_swap(std::next(begin), begin, comp);
+				}
+				else {
+					return;
+				}
+			}
+
+		};
+
+		/**
+		* @brief ブロックマージソート（GrailSort方式）
+		* @detail 範囲から異なる値の要素を集め、ブロックの目印（タグ）と内部バッファに使う。マージは内部バッファとの要素の入れ替えで行うので、作業領域なしで安定にソートできる
+		* @detail 長い区間のマージは、両側を√N程度のブロックに分けて先頭の要素の順に並べ替え、隣り合うブロック同士を順にマージする
+		* @detail 目印とバッファに足りるだけの異なる値がない時は、集めた要素を全て目印に使い、ブロック同士を回転でマージする（値の種類が少ないので回転の回数も少ない）
+		* @detail 呼び出し側の作業領域を渡すと、その容量に収まるマージはmarge_sortと同じ退避によるマージで行う（作業領域は拡張しない）
+		*/
+		struct block_merge_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::merge;
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				//容量0なので確保は起きない
+				workspace<value_t> buffer{};
+
+				sort(begin, end, std::forward<Compare>(comp), buffer);
+			}
+
+			/**
+			* @brief 呼び出し側の作業領域を併用してソートする
+			* @detail 作業領域は今の容量のまま使う。recommended_workspace_size(N)程度あれば、内部バッファを使うマージの多くが退避によるマージに置き換わる
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param buffer 作業領域（容量0でもよい）
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T, typename Allocator>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp, workspace<T, Allocator>& buffer) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				static_assert(std::is_same_v<T, value_t>, "The element type of workspace must be the value_type of the iterator.");
+
+				const auto N = std::size_t(end - begin);
+
+				if (N <= small_sort_size) {
+					insertion_sort::sort(begin, end, comp);
+					return;
+				}
+
+				//作業領域が十分にあれば、そのままマージソートする
+				if (marge_sort::workspace_size(N) <= buffer.capacity()) {
+					marge_sort::sort(begin, end, comp, buffer);
+					return;
+				}
+
+				//ブロック長（√N以上の2の累乗）と、必要な目印の数
+				const auto block = block_size(N);
+				const auto tag_count = N / block + 1;
+				const auto key_count = tag_count + block;
+
+				//異なる値の要素を先頭へ集める
+				const auto found = collect_keys(begin, end, key_count, comp);
+				const auto rest = begin + found;
+
+				if (found < key_count) {
+					//異なる値が足りなければ、全て目印にして回転でマージする
+					if (1 < found) tag_merge_sort(begin, found, rest, end, comp, buffer);
+				}
+				else {
+					//[begin, begin + tag_count)が目印、続くblock要素が内部バッファ
+					internal_buffer_merge_sort(begin, begin + tag_count, rest, end, block, comp, buffer);
+				}
+
+				//目印とバッファは並びが崩れているので、並べ直してから残りとマージする
+				insertion_sort::sort(begin, rest, comp);
+				lazy_merge(begin, rest, end, comp, buffer);
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+			/**
+			* @brief 内部バッファと同じ大きさの作業領域の要素数
+			* @param N ソートする要素数
+			*/
+			static constexpr auto recommended_workspace_size(std::size_t N) noexcept -> std::size_t {
+				return block_size(N);
+			}
+
+		private:
+
+			//これ以下の要素数は挿入ソートする
+			static constexpr std::size_t small_sort_size = 32;
+
+			//最初に挿入ソートで作る整列列の長さ
+			static constexpr std::size_t run_size = 16;
+
+			static constexpr auto block_size(std::size_t N) noexcept -> std::size_t {
+				std::size_t block = run_size;
+				while (block * block < N) block *= 2;
+				return block;
+			}
+
+			/**
+			* @brief 作業領域に収まるならmarge_sortのマージを使う
+			* @return マージしたか
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T, typename Allocator>
+			static bool merge_with_workspace(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare& comp, workspace<T, Allocator>& buffer) {
+				if (buffer.capacity() < std::size_t(std::min(middle - first, last - middle))) return false;
+
+				marge_sort::merge(first, middle, last, comp, buffer);
+				return true;
+			}
+
+			/**
+			* @brief 異なる値の要素を最大count個、昇順に範囲の先頭へ集める
+			* @detail 各値の最初の要素を集め、残りの要素の順序は保つ（回転だけで動かす）
+			* @return 集めた要素数
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static auto collect_keys(RandomAccessIterator begin, RandomAccessIterator end, std::size_t count, Compare& comp) -> std::size_t {
+				//集めた要素は[keys, keys + found)に昇順に並んでいる
+				auto keys = begin;
+				std::size_t found = 1;
+
+				for (auto it = std::next(begin); it != end && found < count; ++it) {
+					auto pos = std::lower_bound(keys, keys + found, *it, comp);
+					if (pos != keys + found && comp(*it, *pos) == false) continue;
+
+					//集めた区間をitの直前へ動かしてから、*itを挿入位置へ入れる
+					const auto offset = pos - keys;
+					std::rotate(keys, keys + found, it);
+					keys = it - found;
+					std::rotate(keys + offset, it, std::next(it));
+					++found;
+				}
+
+				std::rotate(begin, keys, keys + found);
+				return found;
+			}
+
+			/**
+			* @brief [first, middle)を内部バッファと入れ替えてから、[middle, last)と先頭からマージする
+			* @detail 書き込み位置と右側の読み出し位置の間には常にバッファの要素がある。終わるとバッファの要素は全てバッファへ戻る（順序は変わる）
+			* @param right_first_on_tie 同値の時に右側を先にするか
+			* @return 未マージで残った末尾の区間の初めと、それが右側の要素か
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static auto swap_merge(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, RandomAccessIterator buffer, Compare& comp, bool right_first_on_tie) -> std::pair<RandomAccessIterator, bool> {
+				auto left_head = buffer;
+				const auto left_end = std::swap_ranges(first, middle, buffer);
+				auto right_head = middle;
+				auto out = first;
+
+				while (left_head != left_end && right_head != last) {
+					const bool take_right = right_first_on_tie ? (comp(*left_head, *right_head) == false) : comp(*right_head, *left_head);
+					if (take_right) {
+						std::iter_swap(out, right_head);
+						++right_head;
+					}
+					else {
+						std::iter_swap(out, left_head);
+						++left_head;
+					}
+					++out;
+				}
+
+				if (left_head != left_end) {
+					//右側が先に尽きた。左側の残りを末尾へ
+					std::swap_ranges(left_head, left_end, out);
+					return { out, false };
+				}
+
+				//左側が先に尽きた。右側の残りは既に末尾にある
+				return { right_head, true };
+			}
+
+			/**
+			* @brief [middle, last)を内部バッファと入れ替えてから、[first, middle)と末尾から逆向きにマージする
+			* @detail 同値の要素は左側が先に並ぶ
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static void swap_merge_backward(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, RandomAccessIterator buffer, Compare& comp) {
+				auto right_tail = std::swap_ranges(middle, last, buffer);
+				auto left_tail = middle;
+				auto out = last;
+
+				while (right_tail != buffer && left_tail != first) {
+					//*right < *left の時だけ左側を後ろへ
+					if (comp(*std::prev(right_tail), *std::prev(left_tail))) {
+						std::iter_swap(--out, --left_tail);
+					}
+					else {
+						std::iter_swap(--out, --right_tail);
+					}
+				}
+
+				//左側が先に尽きた場合、右側の残りを先頭へ
+				std::swap_ranges(buffer, right_tail, first);
+			}
+
+			/**
+			* @brief ブロック単位のマージ
+			* @detail 両側をblock要素ずつのブロックに分け、先頭の要素の順にブロックを選択ソートしてから、左右の異なる側から来た隣り合うブロックをマージする
+			* @detail 右側の端数（block未満）は最後に末尾から逆向きにマージする
+			* @param has_buffer bufferを使うか（使わない時はブロック同士を回転でマージする）
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static void block_merge(RandomAccessIterator tags, RandomAccessIterator buffer, bool has_buffer, RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, std::size_t block, Compare& comp) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+				const auto left_blocks = std::size_t(middle - first) / block;
+				const auto right_blocks = std::size_t(last - middle) / block;
+				const auto blocks = left_blocks + right_blocks;
+				const auto regular_last = middle + diff_t(right_blocks * block);
+
+				auto block_head = [first, block](std::size_t i) { return first + diff_t(i * block); };
+
+				if (right_blocks != 0) {
+					//目印は全て異なる値なので、ソートすれば元のブロックの順に対応する
+					insertion_sort::sort(tags, tags + diff_t(blocks), comp);
+
+					//右側の最初のブロックの目印。これより小さい目印は左側のブロック
+					auto midkey = tags + diff_t(left_blocks);
+
+					//先頭の要素の順にブロックを選択ソートする。先頭が同値なら目印の順（左側が先、同じ側なら元の順）
+					for (std::size_t i = 0; i < blocks; ++i) {
+						auto min = i;
+						for (std::size_t j = i + 1; j < blocks; ++j) {
+							if (comp(*block_head(j), *block_head(min)) || (comp(*block_head(min), *block_head(j)) == false && comp(tags[diff_t(j)], tags[diff_t(min)]))) min = j;
+						}
+						if (min == i) continue;
+
+						std::swap_ranges(block_head(i), block_head(i + 1), block_head(min));
+						std::iter_swap(tags + diff_t(i), tags + diff_t(min));
+						if (midkey == tags + diff_t(i)) midkey = tags + diff_t(min);
+						else if (midkey == tags + diff_t(min)) midkey = tags + diff_t(i);
+					}
+
+					//マージが済んでいない末尾の区間（どちらか一方の側の要素だけからなる）
+					auto fragment = first;
+					bool fragment_from_left = comp(*tags, *midkey);
+
+					for (std::size_t i = 1; i < blocks; ++i) {
+						const bool from_left = comp(tags[diff_t(i)], *midkey);
+
+						//同じ側のブロックが続くなら、それより前は確定している
+						if (from_left == fragment_from_left) {
+							fragment = block_head(i);
+							continue;
+						}
+
+						//同値は左側の要素が先
+						auto [rest, rest_is_block] = has_buffer ? swap_merge(fragment, block_head(i), block_head(i + 1), buffer, comp, from_left) : rotation_merge(fragment, block_head(i), block_head(i + 1), comp, from_left);
+						fragment = rest;
+						if (rest_is_block) fragment_from_left = from_left;
+					}
+				}
+
+				if (regular_last != last) {
+					if (has_buffer) swap_merge_backward(first, regular_last, last, buffer, comp);
+					else rotation_merge_backward(first, regular_last, last, comp);
+				}
+			}
+
+			/**
+			* @brief 内部バッファを使うボトムアップのマージソート
+			* @detail 左側がバッファに収まる間はバッファとの入れ替えでマージし、それより長くなったらブロック単位でマージする
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T, typename Allocator>
+			static void internal_buffer_merge_sort(RandomAccessIterator tags, RandomAccessIterator buffer, RandomAccessIterator first, RandomAccessIterator last, std::size_t block, Compare& comp, workspace<T, Allocator>& ext) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+				const auto N = std::size_t(last - first);
+
+				for (std::size_t i = 0; i < N; i += run_size) {
+					insertion_sort::sort(first + diff_t(i), first + diff_t(std::min(i + run_size, N)), comp);
+				}
+
+				for (std::size_t width = run_size; width < N; width *= 2) {
+					for (std::size_t i = 0; i + width < N; i += 2 * width) {
+						const auto left = first + diff_t(i);
+						const auto middle = left + diff_t(width);
+						const auto right = first + diff_t(std::min(i + 2 * width, N));
+
+						//既に並んでいる
+						if (comp(*middle, *std::prev(middle)) == false) continue;
+
+						if (merge_with_workspace(left, middle, right, comp, ext)) continue;
+
+						if (width <= block) {
+							swap_merge(left, middle, right, buffer, comp, false);
+						}
+						else {
+							block_merge(tags, buffer, true, left, middle, right, block, comp);
+						}
+					}
+				}
+			}
+
+			/**
+			* @brief 目印だけを使うボトムアップのマージソート
+			* @detail 左側が目印の数以下の間は目印を内部バッファに使ってマージする
+			* @detail それより長くなったら、目印の数が足りるようにブロックを長くし、ブロック同士を回転でマージする
+			* @param tag_count 目印の数（2以上）
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T, typename Allocator>
+			static void tag_merge_sort(RandomAccessIterator tags, std::size_t tag_count, RandomAccessIterator first, RandomAccessIterator last, Compare& comp, workspace<T, Allocator>& ext) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+				const auto N = std::size_t(last - first);
+
+				for (std::size_t i = 0; i < N; i += run_size) {
+					insertion_sort::sort(first + diff_t(i), first + diff_t(std::min(i + run_size, N)), comp);
+				}
+
+				for (std::size_t width = run_size; width < N; width *= 2) {
+					//ブロック数（2 * width / block以下）が目印の数に収まり、ブロックの選択ソートがO(width)に収まるブロック長
+					//tag_countが2以上なのでwidthを超えない
+					std::size_t block = run_size;
+					while (block * tag_count < 2 * width || block * block < 2 * width) block *= 2;
+
+					for (std::size_t i = 0; i + width < N; i += 2 * width) {
+						const auto left = first + diff_t(i);
+						const auto middle = left + diff_t(width);
+						const auto right = first + diff_t(std::min(i + 2 * width, N));
+
+						if (comp(*middle, *std::prev(middle)) == false) continue;
+
+						if (merge_with_workspace(left, middle, right, comp, ext)) continue;
+
+						if (width <= tag_count) {
+							swap_merge(left, middle, right, tags, comp, false);
+						}
+						else {
+							block_merge(tags, tags, false, left, middle, right, block, comp);
+						}
+					}
+				}
+			}
+
+			/**
+			* @brief 短い左側[first, middle)を回転で右側とマージする
+			* @detail 左側の先頭より前に来る右側の要素をまとめて回転で前へ移すことを繰り返す。回転の回数は値の種類で抑えられる
+			* @param right_first_on_tie 同値の時に右側を先にするか
+			* @return 未マージで残った末尾の区間の初めと、それが右側の要素か
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static auto rotation_merge(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare& comp, bool right_first_on_tie) -> std::pair<RandomAccessIterator, bool> {
+				while (first != middle && middle != last) {
+					//左側の先頭より前に来る右側の要素を前へ
+					const auto right_cut = right_first_on_tie ? std::upper_bound(middle, last, *first, comp) : std::lower_bound(middle, last, *first, comp);
+					if (right_cut != middle) {
+						first = std::rotate(first, middle, right_cut);
+						middle = right_cut;
+						if (middle == last) break;
+					}
+
+					//右側の先頭より前に来る左側の要素は確定
+					first = right_first_on_tie ? std::lower_bound(first, middle, *middle, comp) : std::upper_bound(first, middle, *middle, comp);
+				}
+
+				//右側が先に尽きた場合、左側の残りが末尾にある
+				if (first != middle) return { first, false };
+				return { middle, true };
+			}
+
+			/**
+			* @brief 短い右側[middle, last)を回転で左側と末尾からマージする
+			* @detail 同値の要素は左側が先に並ぶ
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static void rotation_merge_backward(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare& comp) {
+				while (first != middle && middle != last) {
+					//右側の末尾より後ろに来る左側の要素を後ろへ
+					const auto left_cut = std::upper_bound(first, middle, *std::prev(last), comp);
+					if (left_cut != middle) {
+						last = std::rotate(left_cut, middle, last);
+						middle = left_cut;
+						if (first == middle) break;
+					}
+
+					//左側の末尾より後ろに来る右側の要素は確定
+					last = std::lower_bound(middle, last, *std::prev(middle), comp);
+				}
+			}
+
+			/**
+			* @brief 短い左側[first, middle)を長い右側とマージする
+			* @detail 作業領域に収まらなければ回転でマージする。左側の要素数をkとしてO(k^2 + N)
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T, typename Allocator>
+			static void lazy_merge(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare& comp, workspace<T, Allocator>& ext) {
+				if (merge_with_workspace(first, middle, last, comp, ext)) return;
+
+				rotation_merge(first, middle, last, comp, false);
+			}
+		};
+
+		/**
+		* @brief ティムソート（マージ順序はpowersort）
+		* @detail 既存の昇順・狭義の降順の連（ラン）を見つけて使い、短いランは二分挿入ソートで最小ラン長まで伸ばす
+		* @detail マージ順序はランの境界の位置から決めるpowersortの規則に従い、マージ中に一方から連続して取り出す時はギャロッピングで区間ごと移す
+		* @detail 整列済みの入力はO(N)で終わり、作業領域も確保しない
+		*/
+		struct tim_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::merge;
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				workspace<value_t> buffer{};
+
+				sort(begin, end, std::forward<Compare>(comp), buffer);
+			}
+
+			/**
+			* @brief 呼び出し側の作業領域を使ってソートする
+			* @detail 作業領域はマージする短い方のランの長さ（最大でN/2要素）まで、必要になった時に拡張する
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param buffer 作業領域
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T, typename Allocator>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp, workspace<T, Allocator>& buffer) {
+				static_assert(std::is_same_v<T, typename std::iterator_traits<RandomAccessIterator>::value_type>, "The element type of workspace must be the value_type of the iterator.");
+
+				//要素数
+				const auto N = std::size_t(end - begin);
+
+				if (N < 2) return;
+
+				const auto min_run = min_run_length(N);
+
+				//ランの開始位置・長さと、次のランとの境界のpowersortにおける深さ
+				struct run {
+					std::size_t first;
+					std::size_t length;
+					std::size_t power;
+				};
+				std::vector<run> stack;
+
+				auto merge_runs = [&](const run& left, const run& right) -> run {
+					merge_at(begin + left.first, left.length, right.length, comp, buffer);
+					return { left.first, left.length + right.length, left.power };
+				};
+
+				run current{ 0, next_run(begin, end, N, min_run, comp), 0 };
+
+				while (current.first + current.length < N) {
+					const run next{ current.first + current.length, next_run(begin + (current.first + current.length), end, N - (current.first + current.length), min_run, comp), 0 };
+
+					//境界が浅い（木の根に近い）ランより深いものを先にマージする
+					const auto power = node_power(current.first, current.length, next.length, N);
+					while (stack.empty() == false && power < stack.back().power) {
+						current = merge_runs(stack.back(), current);
+						stack.pop_back();
+					}
+
+					current.power = power;
+					stack.push_back(current);
+					current = next;
+				}
+
+				while (stack.empty() == false) {
+					current = merge_runs(stack.back(), current);
+					stack.pop_back();
+				}
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			//ギャロッピングに切り替えるまでに、一方から連続して取り出す回数
+			static constexpr std::size_t min_gallop = 7;
+
+			/**
+			* @brief 最小ラン長を求める
+			* @detail N/最小ラン長が2の冪かそれより少し小さくなるように、32〜64の範囲で選ぶ
+			*/
+			static constexpr auto min_run_length(std::size_t N) noexcept -> std::size_t {
+				std::size_t r = 0;
+				while (64 <= N) {
+					r |= N & 1;
+					N >>= 1;
+				}
+				return N + r;
+			}
+
+			/**
+			* @brief 隣り合う2つのランの境界の深さを求める（powersort）
+			* @param first 左のランの開始位置
+			* @param left 左のランの長さ
+			* @param right 右のランの長さ
+			* @param N 全体の要素数
+			*/
+			static constexpr auto node_power(std::size_t first, std::size_t left, std::size_t right, std::size_t N) noexcept -> std::size_t {
+				//2つのランの中点を2Nで正規化した位置が、初めて異なる2進桁
+				auto l = 2 * first + left;
+				auto r = 2 * first + 2 * left + right;
+				const auto two_n = 2 * N;
+
+				std::size_t power = 0;
+				while (true) {
+					++power;
+					if (two_n <= l) {
+						l -= two_n;
+						r -= two_n;
+					}
+					else if (two_n <= r) {
+						break;
+					}
+					l <<= 1;
+					r <<= 1;
+				}
+				return power;
+			}
+
+			/**
+			* @brief 先頭から始まるランを見つけ、最小ラン長に満たなければ二分挿入ソートで伸ばす
+			* @detail 狭義の降順のランは反転する（同値の要素を含まないので安定性は崩れない）
+			* @return ランの長さ
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static auto next_run(RandomAccessIterator begin, RandomAccessIterator end, std::size_t rest, std::size_t min_run, Compare& comp) -> std::size_t {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				auto run_end = std::next(begin);
+
+				if (run_end != end) {
+					if (comp(*run_end, *begin)) {
+						do ++run_end; while (run_end != end && comp(*run_end, *std::prev(run_end)));
+						std::reverse(begin, run_end);
+					}
+					else {
+						do ++run_end; while (run_end != end && comp(*run_end, *std::prev(run_end)) == false);
+					}
+				}
+
+				const auto length = std::size_t(run_end - begin);
+				if (min_run <= length) return length;
+
+				//二分挿入ソートで伸ばす
+				const auto forced = std::min(min_run, rest);
+				const auto forced_end = begin + forced;
+				for (; run_end != forced_end; ++run_end) {
+					//同値の要素の後ろへ挿入する
+					const auto pos = std::upper_bound(begin, run_end, *run_end, comp);
+					if (pos == run_end) continue;
+
+					value_t tmp = std::move(*run_end);
+					std::move_backward(pos, run_end, std::next(run_end));
+					*pos = std::move(tmp);
+				}
+				return forced;
+			}
+
+			/**
+			* @brief predが初めてtrueになる位置を、先頭から指数的に広げて探す
+			* @detail [first, last)はpredについて区分化されていること
+			*/
+			template<typename Iterator, typename Predicate>
+			static auto gallop_forward(Iterator first, Iterator last, Predicate pred) -> Iterator {
+				using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+
+				const auto n = diff_t(last - first);
+				diff_t hi = 1;
+				while (hi <= n && pred(first[hi - 1]) == false) hi *= 2;
+
+				return std::partition_point(first + hi / 2, first + std::min(hi, n), [&](const auto& v) { return pred(v) == false; });
+			}
+
+			/**
+			* @brief predが初めてtrueになる位置を、末尾から指数的に広げて探す
+			* @detail [first, last)はpredについて区分化されていること
+			*/
+			template<typename Iterator, typename Predicate>
+			static auto gallop_backward(Iterator first, Iterator last, Predicate pred) -> Iterator {
+				using diff_t = typename std::iterator_traits<Iterator>::difference_type;
+
+				const auto n = diff_t(last - first);
+				diff_t hi = 1;
+				while (hi <= n && pred(last[-hi])) hi *= 2;
+
+				return std::partition_point((n < hi) ? first : last - (hi - 1), last - hi / 2, [&](const auto& v) { return pred(v) == false; });
+			}
+
+			/**
+			* @brief 隣り合う2つのランをマージする
+			* @detail 既に正しい位置にある左のランの先頭と右のランの末尾を除いてから、短い方のランを作業領域へ移してマージする
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T, typename Allocator>
+			static void merge_at(RandomAccessIterator first, std::size_t left_length, std::size_t right_length, Compare& comp, workspace<T, Allocator>& buffer) {
+				const auto middle = first + left_length;
+				auto last = middle + right_length;
+
+				//右のランの先頭より前に並ぶ左のランの要素は動かない
+				first = gallop_forward(first, middle, [&](const T& v) { return comp(*middle, v); });
+				if (first == middle) return;
+
+				//左のランの末尾より後に並ぶ右のランの要素は動かない
+				const auto& left_last = *std::prev(middle);
+				last = gallop_backward(middle, last, [&](const T& v) { return comp(v, left_last) == false; });
+
+				left_length = std::size_t(middle - first);
+				right_length = std::size_t(last - middle);
+
+				if (left_length <= right_length) {
+					buffer.reserve(left_length);
+					merge_low(first, middle, last, comp, buffer.data());
+				}
+				else {
+					buffer.reserve(right_length);
+					merge_high(first, middle, last, comp, buffer.data());
+				}
+			}
+
+			/**
+			* @brief 左のランを作業領域へ移し、先頭から書き込む
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T>
+			static void merge_low(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare& comp, T* workspace) {
+				T* const buffer_end = std::uninitialized_move(first, middle, workspace);
+
+				T* left = workspace;
+				auto right = middle;
+				auto out = first;
+
+				//左のランの残りを戻して作業領域を破棄する（例外で抜けた場合も）
+				struct restore_guard {
+					T* workspace;
+					T* buffer_end;
+					T*& left;
+					RandomAccessIterator& out;
+
+					~restore_guard() {
+						std::move(left, buffer_end, out);
+						std::destroy(workspace, buffer_end);
+					}
+				} guard{ workspace, buffer_end, left, out };
+
+				while (left != buffer_end && right != last) {
+					std::size_t left_wins = 0;
+					std::size_t right_wins = 0;
+
+					//1要素ずつマージし、一方が続けて勝てばギャロッピングに移る
+					while (left != buffer_end && right != last && left_wins < min_gallop && right_wins < min_gallop) {
+						if (comp(*right, *left)) {
+							*out = std::move(*right);
+							++right;
+							++right_wins;
+							left_wins = 0;
+						}
+						else {
+							*out = std::move(*left);
+							++left;
+							++left_wins;
+							right_wins = 0;
+						}
+						++out;
+					}
+
+					//ギャロッピング：区間ごとに移し、どちらも短くなれば1要素ずつに戻る
+					while (left != buffer_end && right != last) {
+						const auto left_run = gallop_forward(left, buffer_end, [&](const T& v) { return comp(*right, v); });
+						out = std::move(left, left_run, out);
+						const auto left_count = std::size_t(left_run - left);
+						left = left_run;
+						if (left == buffer_end) break;
+
+						const auto right_run = gallop_forward(right, last, [&](const T& v) { return comp(v, *left) == false; });
+						out = std::move(right, right_run, out);
+						const auto right_count = std::size_t(right_run - right);
+						right = right_run;
+
+						if (left_count < min_gallop && right_count < min_gallop) break;
+					}
+				}
+				//右のランが先に尽きた場合、左のランの残りはguardが移動する
+				//左のランが先に尽きた場合、右のランの残りは既に正しい位置にある
+			}
+
+			/**
+			* @brief 右のランを作業領域へ移し、末尾から書き込む
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename T>
+			static void merge_high(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare& comp, T* workspace) {
+				T* const buffer_end = std::uninitialized_move(middle, last, workspace);
+
+				//それぞれの残りの末尾（半開区間の終わり）
+				auto left = middle;
+				T* right = buffer_end;
+				auto out = last;
+
+				//右のランの残りを戻して作業領域を破棄する（例外で抜けた場合も）
+				struct restore_guard {
+					T* workspace;
+					T* buffer_end;
+					T*& right;
+					RandomAccessIterator& out;
+
+					~restore_guard() {
+						std::move_backward(workspace, right, out);
+						std::destroy(workspace, buffer_end);
+					}
+				} guard{ workspace, buffer_end, right, out };
+
+				while (left != first && right != workspace) {
+					std::size_t left_wins = 0;
+					std::size_t right_wins = 0;
+
+					//後ろから1要素ずつマージする（同値は右のランの要素が後）
+					while (left != first && right != workspace && left_wins < min_gallop && right_wins < min_gallop) {
+						--out;
+						if (comp(*std::prev(right), *std::prev(left))) {
+							--left;
+							*out = std::move(*left);
+							++left_wins;
+							right_wins = 0;
+						}
+						else {
+							--right;
+							*out = std::move(*right);
+							++right_wins;
+							left_wins = 0;
+						}
+					}
+
+					while (left != first && right != workspace) {
+						//右のランの末尾より後に並ぶ左のランの要素
+						const auto& right_back = *std::prev(right);
+						const auto left_run = gallop_backward(first, left, [&](const T& v) { return comp(right_back, v); });
+						out = std::move_backward(left_run, left, out);
+						const auto left_count = std::size_t(left - left_run);
+						left = left_run;
+						if (left == first) break;
+
+						//左のランの末尾と同じかより後に並ぶ右のランの要素
+						const auto& left_back = *std::prev(left);
+						const auto right_run = gallop_backward(workspace, right, [&](const T& v) { return comp(v, left_back) == false; });
+						out = std::move_backward(right_run, right, out);
+						const auto right_count = std::size_t(right - right_run);
+						right = right_run;
+
+						if (left_count < min_gallop && right_count < min_gallop) break;
+					}
+				}
+				//左のランが先に尽きた場合、右のランの残りはguardが移動する
+				//右のランが先に尽きた場合、左のランの残りは既に正しい位置にある
+			}
+		};
+
+		/**
+		* @brief パターン破壊クイックソート（pdqsort）
+		* @detail ninther/3点中央値でピボットを選び、偏った分割が続けばヒープソートへ切り替える（最悪O(N log N)）
+		* @detail 算術型を標準の比較ファンクタでソートする時は、ブロック分割で分岐予測ミスを避ける
+		*/
+		struct pdq_sort {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::partitioning;
+
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = detail::comp_v<RandomAccessIterator>) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				if (begin == end) return;
+
+				//ブロック分割を使うか
+				constexpr bool branchless = std::is_arithmetic_v<value_t> && detail::is_standard_compare_v<Compare, value_t>;
+
+				pdqsort_loop<branchless>(begin, end, comp, log2(end - begin), true);
+			}
+
+			template<typename RandomAccessIterator, typename Compare>
+			constexpr void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = detail::comp_v<RandomAccessIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			//これ未満の要素数は挿入ソートする
+			static constexpr std::ptrdiff_t insertion_sort_threshold = 24;
+			//これより多い要素数ではnintherでピボットを選ぶ
+			static constexpr std::ptrdiff_t ninther_threshold = 128;
+			//部分挿入ソートで諦めるまでに許す移動量
+			static constexpr std::size_t partial_insertion_sort_limit = 8;
+			//ブロック分割の1ブロックの要素数
+			static constexpr std::size_t block_size = 64;
+			//オフセットバッファの整列に使うキャッシュラインサイズ
+			static constexpr std::size_t cacheline_size = 64;
+
+			template<typename T>
+			static constexpr auto log2(T n) -> int {
+				int log = 0;
+				while (n >>= 1) ++log;
+				return log;
+			}
+
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare& comp) {
+				detail::compare_and_swap(b, a, comp);
+				detail::compare_and_swap(c, b, comp);
+				detail::compare_and_swap(b, a, comp);
+			}
+
+			/**
+			* @brief 挿入ソート
+			* @param leftmost falseなら範囲の直前に全要素以下の要素があるものとして、左端の判定を省く
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void insertion_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp, bool leftmost) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				if (begin == end) return;
+
+				for (auto current = begin + 1; current != end; ++current) {
+					auto sift = current;
+					auto sift_1 = current - 1;
+
+					//正順であれば次へ
+					if (comp(*sift, *sift_1) == false) continue;
+
+					value_t tmp = std::move(*sift);
+
+					do {
+						*sift-- = std::move(*sift_1);
+					} while ((leftmost == false || sift != begin) && comp(tmp, *--sift_1));
+
+					*sift = std::move(tmp);
+				}
+			}
+
+			/**
+			* @brief 移動量が少なければ挿入ソートを完了させる
+			* @return ソートが完了したか
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr auto partial_insertion_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) -> bool {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				if (begin == end) return true;
+
+				std::size_t limit = 0;
+				for (auto current = begin + 1; current != end; ++current) {
+					auto sift = current;
+					auto sift_1 = current - 1;
+
+					if (comp(*sift, *sift_1)) {
+						value_t tmp = std::move(*sift);
+
+						do {
+							*sift-- = std::move(*sift_1);
+						} while (sift != begin && comp(tmp, *--sift_1));
+
+						*sift = std::move(tmp);
+						limit += std::size_t(current - sift);
+					}
+
+					if (partial_insertion_sort_limit < limit) return false;
+				}
+
+				return true;
+			}
+
+			/**
+			* @brief 左右のオフセットが指す要素を入れ替える
+			* @param use_swaps 左右の数が等しい時はswapで、そうでなければ巡回させて移動する
+			*/
+			template<typename RandomAccessIterator>
+			static void swap_offsets(RandomAccessIterator first, RandomAccessIterator last, const unsigned char* offsets_l, const unsigned char* offsets_r, std::size_t num, bool use_swaps) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				if (use_swaps) {
+					for (std::size_t i = 0; i < num; ++i) {
+						std::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+					}
+				}
+				else if (0 < num) {
+					auto l = first + offsets_l[0];
+					auto r = last - offsets_r[0];
+					value_t tmp = std::move(*l);
+					*l = std::move(*r);
+					for (std::size_t i = 1; i < num; ++i) {
+						l = first + offsets_l[i];
+						*r = std::move(*l);
+						r = last - offsets_r[i];
+						*l = std::move(*r);
+					}
+					*r = std::move(tmp);
+				}
+			}
+
+			/**
+			* @brief 先頭要素をピボットとし、ピボット未満を左、以上を右へ分割する
+			* @detail ピボットとの比較結果をオフセットとしてブロック単位で記録し、まとめて入れ替えるので比較結果で分岐しない
+			* @return ピボットの位置と、分割前から分割済みだったか
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static auto partition_right_branchless(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) -> std::pair<RandomAccessIterator, bool> {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				value_t pivot = std::move(*begin);
+				auto first = begin;
+				auto last = end;
+
+				//ピボット以上の最初の要素を探す（ピボットの3点中央値選択により番兵が存在する）
+				while (comp(*++first, pivot));
+
+				//ピボット未満の最後の要素を探す
+				if (first - 1 == begin) while (first < last && comp(*--last, pivot) == false);
+				else while (comp(*--last, pivot) == false);
+
+				//最初の入れ替え対象の組が交差していれば分割済み
+				const bool already_partitioned = last <= first;
+				if (already_partitioned == false) {
+					std::iter_swap(first, last);
+					++first;
+				}
+
+				//キャッシュラインに揃えたオフセットバッファ
+				alignas(cacheline_size) unsigned char offsets_l[block_size];
+				alignas(cacheline_size) unsigned char offsets_r[block_size];
+
+				auto offsets_l_base = first;
+				auto offsets_r_base = last;
+				std::size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+				while (first < last) {
+					//未処理の要素を左右のブロックへ割り当てる
+					const auto num_unknown = std::size_t(last - first);
+					const auto left_split = (num_l == 0) ? ((num_r == 0) ? num_unknown / 2 : num_unknown) : 0;
+					const auto right_split = (num_r == 0) ? (num_unknown - left_split) : 0;
+
+					//左側ブロックでピボット以上の要素のオフセットを記録
+					for (std::size_t i = 0, n = std::min(left_split, block_size); i < n; ++i) {
+						offsets_l[num_l] = static_cast<unsigned char>(i);
+						num_l += (comp(*first, pivot) == false);
+						++first;
+					}
+
+					//右側ブロックでピボット未満の要素のオフセットを記録
+					for (std::size_t i = 0, n = std::min(right_split, block_size); i < n;) {
+						offsets_r[num_r] = static_cast<unsigned char>(++i);
+						num_r += comp(*--last, pivot);
+					}
+
+					//記録した組を入れ替える
+					const auto num = std::min(num_l, num_r);
+					swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+					num_l -= num;
+					num_r -= num;
+					start_l += num;
+					start_r += num;
+
+					if (num_l == 0) {
+						start_l = 0;
+						offsets_l_base = first;
+					}
+					if (num_r == 0) {
+						start_r = 0;
+						offsets_r_base = last;
+					}
+				}
+
+				//片側に残ったオフセットの要素を境界へ寄せる
+				if (num_l != 0) {
+					while (num_l--) std::iter_swap(offsets_l_base + offsets_l[start_l + num_l], --last);
+					first = last;
+				}
+				if (num_r != 0) {
+					while (num_r--) {
+						std::iter_swap(offsets_r_base - offsets_r[start_r + num_r], first);
+						++first;
+					}
+					last = first;
+				}
+
+				//ピボットを境界へ置く
+				auto pivot_pos = first - 1;
+				*begin = std::move(*pivot_pos);
+				*pivot_pos = std::move(pivot);
+
+				return { pivot_pos, already_partitioned };
+			}
+
+			/**
+			* @brief 先頭要素をピボットとし、ピボット未満を左、以上を右へ分割する
+			* @return ピボットの位置と、分割前から分割済みだったか
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr auto partition_right(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) -> std::pair<RandomAccessIterator, bool> {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				value_t pivot = std::move(*begin);
+				auto first = begin;
+				auto last = end;
+
+				//ピボット以上の最初の要素を探す（ピボットの3点中央値選択により番兵が存在する）
+				while (comp(*++first, pivot));
+
+				//ピボット未満の最後の要素を探す
+				if (first - 1 == begin) while (first < last && comp(*--last, pivot) == false);
+				else while (comp(*--last, pivot) == false);
+
+				//最初の入れ替え対象の組が交差していれば分割済み
+				const bool already_partitioned = last <= first;
+
+				while (first < last) {
+					detail::iter_swap(first, last);
+					while (comp(*++first, pivot));
+					while (comp(*--last, pivot) == false);
+				}
+
+				//ピボットを境界へ置く
+				auto pivot_pos = first - 1;
+				*begin = std::move(*pivot_pos);
+				*pivot_pos = std::move(pivot);
+
+				return { pivot_pos, already_partitioned };
+			}
+
+			/**
+			* @brief 先頭要素をピボットとし、ピボット以下を左、より大きいものを右へ分割する
+			* @detail ピボットと等しい要素が多い時に、それらをまとめて片付けるために使う
+			* @return ピボットの位置
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr auto partition_left(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) -> RandomAccessIterator {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				value_t pivot = std::move(*begin);
+				auto first = begin;
+				auto last = end;
+
+				while (comp(pivot, *--last));
+
+				if (last + 1 == end) while (first < last && comp(pivot, *++first) == false);
+				else while (comp(pivot, *++first) == false);
+
+				while (first < last) {
+					detail::iter_swap(first, last);
+					while (comp(pivot, *--last));
+					while (comp(pivot, *++first) == false);
+				}
+
+				auto pivot_pos = last;
+				*begin = std::move(*pivot_pos);
+				*pivot_pos = std::move(pivot);
+
+				return pivot_pos;
+			}
+
+			/**
+			* @brief ヒープソート
+			* @detail C++17のstd::make_heap/std::sort_heapはconstexprでないので、定数評価中に使う
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void heap_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+				//[0, size)のヒープで、rootから子の大きい方へ下ろしていく
+				auto sift_down = [begin, &comp](diff_t root, diff_t size) {
+					while (true) {
+						auto child = 2 * root + 1;
+						if (size <= child) return;
+						if (child + 1 < size && comp(begin[child], begin[child + 1])) ++child;
+						if (comp(begin[root], begin[child]) == false) return;
+						detail::iter_swap(begin + root, begin + child);
+						root = child;
+					}
+				};
+
+				const auto N = diff_t(end - begin);
+				for (auto i = N / 2; 0 < i--;) sift_down(i, N);
+				for (auto size = N; 1 < size--;) {
+					detail::iter_swap(begin, begin + size);
+					sift_down(diff_t(0), size);
+				}
+			}
+
+			/**
+			* @param bad_allowed 偏った分割をあと何回許すか（0になったらヒープソートへ切り替える）
+			* @param leftmost 範囲が全体の左端か（falseなら直前の要素が番兵になる）
+			*/
+			template<bool Branchless, typename RandomAccessIterator, typename Compare>
+			static constexpr void pdqsort_loop(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp, int bad_allowed, bool leftmost) {
+				SORT_COLLECTION_INSTRUMENT_RECURSION();
+
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
+
+				while (true) {
+					//要素数
+					const auto N = diff_t(end - begin);
+
+					//少なければ挿入ソート
+					if (N < diff_t(insertion_sort_threshold)) {
+						if constexpr (detail::simd::is_enabled_v<RandomAccessIterator, Compare, stable>) {
+							if (diff_t(1) < N && N <= diff_t(detail::simd::small_sort_size) && detail::is_constant_evaluated() == false) {
+								detail::simd::kernel_for<RandomAccessIterator, Compare>::sort_small(std::addressof(*begin), std::size_t(N));
+								return;
+							}
+						}
+						insertion_sort(begin, end, comp, leftmost);
+						return;
+					}
+
+					//ピボットを選んで先頭に置く
+					const auto half = N / 2;
+					if (diff_t(ninther_threshold) < N) {
+						sort3(begin, begin + half, end - 1, comp);
+						sort3(begin + 1, begin + (half - 1), end - 2, comp);
+						sort3(begin + 2, begin + (half + 1), end - 3, comp);
+						sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+						detail::iter_swap(begin, begin + half);
+					}
+					else {
+						sort3(begin + half, begin, end - 1, comp);
+					}
+
+					//直前の要素（前回のピボット）とピボットが等しければ、等しい要素を左へまとめて片付ける
+					if (leftmost == false && comp(*(begin - 1), *begin) == false) {
+						begin = partition_left(begin, end, comp) + 1;
+						continue;
+					}
+
+					//ブロック分割は初期化しないオフセットバッファを使うので、定数評価中は使えない
+					auto [pivot_pos, already_partitioned] = (Branchless && detail::is_constant_evaluated() == false) ? partition_right_branchless(begin, end, comp) : partition_right(begin, end, comp);
+
+					const auto l_size = diff_t(pivot_pos - begin);
+					const auto r_size = diff_t(end - (pivot_pos + 1));
+
+					if (l_size < N / 8 || r_size < N / 8) {
+						//偏りすぎていればヒープソートへ切り替える
+						if (--bad_allowed == 0) {
+							if (detail::is_constant_evaluated()) {
+								heap_sort(begin, end, comp);
+							}
+							else {
+								std::make_heap(begin, end, comp);
+								std::sort_heap(begin, end, comp);
+							}
+							return;
+						}
+
+						//パターンを崩すために要素を入れ替えておく
+						if (diff_t(insertion_sort_threshold) <= l_size) {
+							detail::iter_swap(begin, begin + l_size / 4);
+							detail::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+
+							if (diff_t(ninther_threshold) < l_size) {
+								detail::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+								detail::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+								detail::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+								detail::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+							}
+						}
+
+						if (diff_t(insertion_sort_threshold) <= r_size) {
+							detail::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+							detail::iter_swap(end - 1, end - r_size / 4);
+
+							if (diff_t(ninther_threshold) < r_size) {
+								detail::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+								detail::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+								detail::iter_swap(end - 2, end - (1 + r_size / 4));
+								detail::iter_swap(end - 3, end - (2 + r_size / 4));
+							}
+						}
+					}
+					else {
+						//分割済みだった範囲は、ほぼ整列済みと見て挿入ソートを試す
+						if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp) && partial_insertion_sort(pivot_pos + 1, end, comp)) return;
+					}
+
+					//左側は再帰、右側はループで処理
+					pdqsort_loop<Branchless>(begin, pivot_pos, comp, bad_allowed, leftmost);
+					begin = pivot_pos + 1;
+					leftmost = false;
+				}
+			}
+		};
+
+		/**
+		* @brief 3分割クイックソート
+		* @detail ピボットより小さい・等しい・大きい区間に分け（Bentley-McIlroyの分割）、ピボットと等しい区間はそれ以上触らない
+		* @detail 異なる値がk種類なら比較はO(N log k)程度で済むので、重複の多い入力に向く。偏った分割が続けばpdqソートへ切り替える（最悪O(N log N)）
+		*/
+		struct three_way_quick_sort {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::partitioning;
+
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = detail::comp_v<RandomAccessIterator>) {
+				if (end - begin < 2) return;
+
+				quick_sort_loop(begin, end, comp, 2 * log2(end - begin));
+			}
+
+			template<typename RandomAccessIterator, typename Compare>
+			constexpr void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = detail::comp_v<RandomAccessIterator>) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			//これ未満の要素数は挿入ソートする
+			static constexpr std::ptrdiff_t insertion_sort_threshold = 16;
+			//これより多い要素数ではnintherでピボットを選ぶ
+			static constexpr std::ptrdiff_t ninther_threshold = 128;
+
+			template<typename T>
+			static constexpr auto log2(T n) -> int {
+				int log = 0;
+				while (n >>= 1) ++log;
+				return log;
+			}
+
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare& comp) {
+				detail::compare_and_swap(b, a, comp);
+				detail::compare_and_swap(c, b, comp);
+				detail::compare_and_swap(b, a, comp);
+			}
+
+			/**
+			* @brief [first, first + n)と[second, second + n)を入れ替える
+			*/
+			template<typename RandomAccessIterator, typename Difference>
+			static constexpr void swap_blocks(RandomAccessIterator first, RandomAccessIterator second, Difference n) {
+				for (Difference i = 0; i < n; ++i) detail::iter_swap(first + i, second + i);
+			}
+
+			/**
+			* @brief 先頭の要素をピボットにして3分割する
+			* @detail 分割中はピボットと等しい要素を両端へ寄せ、最後に中央へ移す。等しい要素が無ければ入れ替えはHoareの分割と同程度
+			* @return ピボット未満の区間の終わりと、ピボットより大きい区間の初め
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr auto partition(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) -> std::pair<RandomAccessIterator, RandomAccessIterator> {
+				//[begin, a)と(d, end)はピボットと等しく、[a, b)は小さく、(c, d]は大きい。[b, c]は未分類
+				auto a = begin + 1, b = begin + 1;
+				auto c = end - 1, d = end - 1;
+				const auto& pivot = *begin;
+
+				while (true) {
+					//既に正しい側にある要素は1回の比較で済む
+					while (b <= c) {
+						if (comp(*b, pivot)) {
+							++b;
+						}
+						else if (comp(pivot, *b)) {
+							break;
+						}
+						else {
+							if (a != b) detail::iter_swap(a, b);
+							++a;
+							++b;
+						}
+					}
+					while (b <= c) {
+						if (comp(pivot, *c)) {
+							--c;
+						}
+						else if (comp(*c, pivot)) {
+							break;
+						}
+						else {
+							if (c != d) detail::iter_swap(c, d);
+							--d;
+							--c;
+						}
+					}
+					if (c < b) break;
+
+					detail::iter_swap(b, c);
+					++b;
+					--c;
+				}
+
+				//両端の等しい要素を中央へ移す
+				const auto less = b - a, greater = d - c;
+				swap_blocks(begin, b - std::min(a - begin, less), std::min(a - begin, less));
+				swap_blocks(b, end - std::min(end - 1 - d, greater), std::min(end - 1 - d, greater));
+
+				return { begin + less, end - greater };
+			}
+
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void quick_sort_loop(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp, int bad_allowed) {
+				SORT_COLLECTION_INSTRUMENT_RECURSION();
+
+				while (true) {
+					const auto N = end - begin;
+
+					//少なければ挿入ソート
+					if (N < insertion_sort_threshold) {
+						insertion_sort::sort(begin, end, comp);
+						return;
+					}
+
+					//偏った分割が続いた
+					if (bad_allowed == 0) {
+						pdq_sort::sort(begin, end, comp);
+						return;
+					}
+					--bad_allowed;
+
+					//ピボットを選んで先頭へ置く
+					const auto mid = begin + N / 2;
+					if (ninther_threshold < N) {
+						sort3(begin, mid, end - 1, comp);
+						sort3(begin + 1, mid - 1, end - 2, comp);
+						sort3(begin + 2, mid + 1, end - 3, comp);
+						sort3(mid - 1, mid, mid + 1, comp);
+					}
+					else {
+						sort3(begin, mid, end - 1, comp);
+					}
+					detail::iter_swap(begin, mid);
+
+					const auto [less_end, greater_begin] = partition(begin, end, comp);
+
+					//短い方を再帰し、長い方はループで続ける
+					if (less_end - begin < end - greater_begin) {
+						quick_sort_loop(begin, less_end, comp, bad_allowed);
+						begin = greater_begin;
+					}
+					else {
+						quick_sort_loop(greater_begin, end, comp, bad_allowed);
+						end = less_end;
+					}
+				}
+			}
+		};
+
+		/**
+		* @brief LSD基数ソート
+		* @detail 射影したキーを符号なし整数に変換し、下位から1バイトずつ分配する（安定）
+		* @detail 全桁のヒストグラムは最初の1回の走査でまとめて求め、全要素が同じ値になる桁は飛ばす
+		* @detail 作業領域を確保できなかった場合は、変換したキーで比較するブロックマージソートで処理する（作業領域を使わず、安定なまま）
+		*/
+		struct radix_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::distribution;
+
+			/**
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素から整数・浮動小数点数のキーを取り出す射影
+			*/
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				workspace<value_t> buffer{};
+
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj), buffer);
+			}
+
+			/**
+			* @brief 呼び出し側の作業領域を使ってソートする
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素から整数・浮動小数点数のキーを取り出す射影
+			* @param buffer 作業領域（N要素必要）
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename Projection, typename T, typename Allocator>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&&, Projection proj, workspace<T, Allocator>& buffer) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+				using key_encoder = detail::radix_key_encoder<RandomAccessIterator, Compare, Projection>;
+
+				static_assert(std::is_same_v<T, value_t>, "The element type of workspace must be the value_type of the iterator.");
+
+				const auto N = std::size_t(end - begin);
+
+				if (N < 2) return;
+
+				const key_encoder encode{ proj };
+
+				//少なければ挿入ソート
+				if (N <= detail::radix_insertion_sort_threshold) {
+					detail::radix_insertion_sort(begin, end, encode);
+					return;
+				}
+
+				try {
+					buffer.reserve(N);
+				}
+				catch (const std::bad_alloc&) {
+					//メモリが足りなければその場でマージする（アメリカンフラッグソートは安定でないので使えない）
+					block_merge_sort::sort(begin, end, [&encode](const value_t& lhs, const value_t& rhs) { return encode(lhs) < encode(rhs); });
+					return;
+				}
+
+				lsd_impl(begin, N, encode, buffer.data());
+			}
+
+			/**
+			* @brief 並列処理に切り替える要素数の閾値
+			* @detail 分配の単位となるブロックの大きさの下限にも使用する
+			*/
+			static inline std::size_t parallel_cutoff = 1 << 16;
+
+			/**
+			* @brief 実行ポリシーを指定してソートする
+			* @detail 並列ポリシーの時、範囲をブロックに分けてブロック毎のヒストグラムを並列に数え、その累積和で決めた書き込み位置へ各ブロックを並列に分配する
+			* @detail 書き込み位置はブロックの順に割り当てるので、並列版も安定。要素のムーブが例外を投げうる型は逐次実行する（射影も例外を投げないこと）
+			* @param policy 実行ポリシー
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素から整数・浮動小数点数のキーを取り出す射影
+			*/
+			template<typename ExecutionPolicy, typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+			static void sort(ExecutionPolicy&&, RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+				using key_encoder = detail::radix_key_encoder<RandomAccessIterator, Compare, Projection>;
+
+				if constexpr (detail::is_parallel_policy_v<ExecutionPolicy> && std::is_nothrow_move_constructible_v<value_t> && std::is_nothrow_move_assignable_v<value_t>) {
+					const auto N = std::size_t(end - begin);
+
+					if (N < parallel_cutoff) {
+						sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+						return;
+					}
+
+					workspace<value_t> buffer{};
+					try {
+						buffer.reserve(N);
+					}
+					catch (const std::bad_alloc&) {
+						//メモリが足りなければ逐次版（その場でマージする）
+						sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+						return;
+					}
+
+					parallel_lsd_impl(begin, N, key_encoder{ proj }, buffer.data(), detail::thread_pool::instance());
+				}
+				else {
+					sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+				}
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) const {
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+			}
+
+			template<typename ExecutionPolicy, typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+			void operator()(ExecutionPolicy&& policy, RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) const {
+				sort(std::forward<ExecutionPolicy>(policy), begin, end, std::forward<Compare>(comp), std::move(proj));
+			}
+
+		private:
+
+			template<typename RandomAccessIterator, typename KeyEncoder, typename T>
+			static void parallel_lsd_impl(RandomAccessIterator begin, std::size_t N, const KeyEncoder& encode, T* buffer, detail::thread_pool& pool) {
+				using key_t = typename KeyEncoder::key_type;
+				using histogram_t = std::array<std::size_t, 256>;
+
+				constexpr std::size_t passes = sizeof(key_t);
+
+				//ブロック数（スレッド数より多めに分けて、ワークスティーリングで偏りをならす）
+				const auto blocks = std::max(std::size_t(1), std::min(N / parallel_cutoff, 4 * pool.concurrency()));
+
+				auto run_blocks = [&](auto& part) {
+					detail::task_group group{ pool };
+					for (std::size_t k = 1; k < blocks; ++k) {
+						group.run([&part, k, N, blocks] { part(k, N * k / blocks, N * (k + 1) / blocks); });
+					}
+					part(std::size_t(0), std::size_t(0), N / blocks);
+					group.wait();
+				};
+
+				//ブロック毎に全ての桁のヒストグラムを1回の走査で求める
+				//最初に分配する桁ではそのまま使い、全体の合計は分配の要らない桁の判定に使う
+				std::vector<std::array<histogram_t, passes>> initial_counts(blocks);
+				SORT_COLLECTION_INSTRUMENT_WORKSPACE(initial_counts.size() * sizeof(initial_counts[0]));
+
+				auto count_all = [&](std::size_t k, std::size_t first, std::size_t last) {
+					auto& count = initial_counts[k];
+					for (std::size_t i = first; i < last; ++i) {
+						const auto key = encode(begin[i]);
+						for (std::size_t pass = 0; pass < passes; ++pass) {
+							++count[pass][detail::radix_digit(key, pass)];
+						}
+					}
+				};
+				run_blocks(count_all);
+
+				//ブロック毎の、現在の桁の書き込み位置
+				std::vector<histogram_t> counts(blocks);
+				SORT_COLLECTION_INSTRUMENT_WORKSPACE(counts.size() * sizeof(histogram_t));
+
+				//作業領域に構築済みの要素があるか
+				bool constructed = false;
+				//現在の並びが作業領域側にあるか
+				bool in_buffer = false;
+
+				//作業領域に構築した要素を破棄する（例外で抜けた場合も）
+				struct destroy_guard {
+					T* buffer;
+					std::size_t N;
+					const bool& constructed;
+
+					~destroy_guard() {
+						if (constructed) std::destroy(buffer, buffer + N);
+					}
+				} guard{ buffer, N, constructed };
+
+				for (std::size_t pass = 0; pass < passes; ++pass) {
+					//全要素がこの桁で同じ値なら並びは変わらない
+					bool trivial = false;
+					for (std::size_t digit = 0; digit < 256 && trivial == false; ++digit) {
+						std::size_t total = 0;
+						for (const auto& count : initial_counts) total += count[pass][digit];
+						trivial = (total == N);
+					}
+					if (trivial) continue;
+
+					if (constructed == false && in_buffer == false) {
+						//まだ要素が動いていないので、最初の走査のヒストグラムがそのまま使える
+						for (std::size_t k = 0; k < blocks; ++k) counts[k] = initial_counts[k][pass];
+					}
+					else {
+						auto count_digit = [&](std::size_t k, std::size_t first, std::size_t last) {
+							auto& count = counts[k];
+							count.fill(0);
+							for (std::size_t i = first; i < last; ++i) {
+								++count[detail::radix_digit(in_buffer ? encode(buffer[i]) : encode(begin[i]), pass)];
+							}
+						};
+						run_blocks(count_digit);
+					}
+
+					//各値の書き込み開始位置を、値の順・ブロックの順に割り当てる
+					std::size_t offset = 0;
+					for (std::size_t digit = 0; digit < 256; ++digit) {
+						for (auto& count : counts) {
+							offset += std::exchange(count[digit], offset);
+						}
+					}
+
+					auto scatter = [&](std::size_t k, std::size_t first, std::size_t last) {
+						auto& count = counts[k];
+						if (in_buffer) {
+							//作業領域から元の範囲へ
+							for (std::size_t i = first; i < last; ++i) {
+								begin[count[detail::radix_digit(encode(buffer[i]), pass)]++] = std::move(buffer[i]);
+							}
+						}
+						else if (constructed) {
+							//元の範囲から作業領域へ
+							for (std::size_t i = first; i < last; ++i) {
+								buffer[count[detail::radix_digit(encode(begin[i]), pass)]++] = std::move(begin[i]);
+							}
+						}
+						else {
+							//元の範囲から未初期化の作業領域へ構築しながら
+							for (std::size_t i = first; i < last; ++i) {
+								::new (static_cast<void*>(buffer + count[detail::radix_digit(encode(begin[i]), pass)]++)) T(std::move(begin[i]));
+							}
+						}
+					};
+					run_blocks(scatter);
+
+					constructed = true;
+					in_buffer = !in_buffer;
+				}
+
+				if (in_buffer) {
+					auto move_back = [&](std::size_t, std::size_t first, std::size_t last) {
+						std::move(buffer + first, buffer + last, begin + first);
+					};
+					run_blocks(move_back);
+				}
+			}
+
+			template<typename RandomAccessIterator, typename KeyEncoder, typename T>
+			static void lsd_impl(RandomAccessIterator begin, std::size_t N, const KeyEncoder& encode, T* buffer) {
+				using key_t = typename KeyEncoder::key_type;
+
+				constexpr std::size_t passes = sizeof(key_t);
+
+				//全ての桁のヒストグラムを1回の走査で求める
+				std::array<std::array<std::size_t, 256>, passes> counts{};
+				for (std::size_t i = 0; i < N; ++i) {
+					const auto key = encode(begin[i]);
+					for (std::size_t pass = 0; pass < passes; ++pass) {
+						++counts[pass][detail::radix_digit(key, pass)];
+					}
+				}
+
+				//作業領域に構築済みの要素があるか
+				bool constructed = false;
+				//現在の並びが作業領域側にあるか
+				bool in_buffer = false;
+
+				//作業領域に構築した要素を破棄する（例外で抜けた場合も）
+				struct destroy_guard {
+					T* buffer;
+					std::size_t N;
+					const bool& constructed;
+
+					~destroy_guard() {
+						if (constructed) std::destroy(buffer, buffer + N);
+					}
+				} guard{ buffer, N, constructed };
+
+				for (std::size_t pass = 0; pass < passes; ++pass) {
+					auto& count = counts[pass];
+
+					//全要素がこの桁で同じ値なら並びは変わらない
+					const auto first_key = in_buffer ? encode(buffer[0]) : encode(begin[0]);
+					if (count[detail::radix_digit(first_key, pass)] == N) continue;
+
+					//各値の書き込み開始位置
+					std::size_t offset = 0;
+					for (auto& c : count) {
+						offset += std::exchange(c, offset);
+					}
+
+					if (in_buffer) {
+						//作業領域から元の範囲へ
+						for (std::size_t i = 0; i < N; ++i) {
+							begin[count[detail::radix_digit(encode(buffer[i]), pass)]++] = std::move(buffer[i]);
+						}
+					}
+					else if (constructed) {
+						//元の範囲から作業領域へ
+						for (std::size_t i = 0; i < N; ++i) {
+							buffer[count[detail::radix_digit(encode(begin[i]), pass)]++] = std::move(begin[i]);
+						}
+					}
+					else {
+						//元の範囲から未初期化の作業領域へ構築しながら
+						//分配は置換になっているので各位置に1度だけ構築される
+						for (std::size_t i = 0; i < N; ++i) {
+							::new (static_cast<void*>(buffer + count[detail::radix_digit(encode(begin[i]), pass)]++)) T(std::move(begin[i]));
+						}
+						constructed = true;
+					}
+
+					in_buffer = !in_buffer;
+				}
+
+				if (in_buffer) {
+					std::move(buffer, buffer + N, begin);
+				}
+			}
+		};
+
+		/**
+		* @brief アメリカンフラッグソート（インプレースのMSD基数ソート）
+		* @detail 上位から1バイトずつ、各値の区間へ要素を巡回的に入れ替えて分配する。作業領域を使わない
+		*/
+		struct american_flag_sort {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::distribution;
+
+			/**
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素から整数・浮動小数点数のキーを取り出す射影
+			*/
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& = Compare{}, Projection proj = {}) {
+				using key_encoder = detail::radix_key_encoder<RandomAccessIterator, Compare, Projection>;
+
+				const key_encoder encode{ proj };
+
+				detail::american_flag_sort_impl(begin, end, encode, sizeof(typename key_encoder::key_type) - 1);
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) const {
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+			}
+		};
+
+		/**
+		* @brief 分布数え上げソート
+		* @detail キーの最小値と最大値を調べ、値域が狭ければ値ごとの個数を数え、その累積和の位置へ要素を並べる（安定、O(N + 値域)）
+		* @detail 値域が要素数（最低256）かmax_rangeより広ければ、LSD基数ソートで処理する
+		* @detail 射影しない整数・列挙型の範囲は、数えた個数から値を書き戻すので作業領域を使わない
+		*/
+		struct counting_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::distribution;
+
+			/**
+			* @brief 値ごとの個数を数える配列の大きさの上限
+			*/
+			static inline std::size_t max_range = std::size_t(1) << 16;
+
+			/**
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素から整数・列挙型のキーを取り出す射影
+			*/
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				workspace<value_t> buffer{};
+
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj), buffer);
+			}
+
+			/**
+			* @brief 呼び出し側の作業領域を使ってソートする
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素から整数・列挙型のキーを取り出す射影
+			* @param buffer 作業領域（射影する場合と基数ソートに切り替えた場合にN要素必要）
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename Projection, typename T, typename Allocator>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp, Projection proj, workspace<T, Allocator>& buffer) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+				using key_encoder = detail::radix_key_encoder<RandomAccessIterator, Compare, Projection>;
+				using key_t = typename key_encoder::key_type;
+
+				static_assert(std::is_same_v<T, value_t>, "The element type of workspace must be the value_type of the iterator.");
+				static_assert(std::is_integral_v<typename key_encoder::projected_type> || std::is_enum_v<typename key_encoder::projected_type>, "Counting sort supports only integral or enum keys.");
+
+				const auto N = std::size_t(end - begin);
+
+				if (N < 2) return;
+
+				const key_encoder encode{ proj };
+
+				//キーの値域
+				key_t min = encode(*begin), max = min;
+				for (auto it = begin + 1; it != end; ++it) {
+					const auto key = encode(*it);
+					min = std::min(min, key);
+					max = std::max(max, key);
+				}
+
+				//64ビットのキーで値域が全体に及ぶと+1が溢れるので、差のまま比べる
+				const auto limit = std::min<std::uint64_t>(max_range, std::max<std::size_t>(N, 256));
+				if (limit == 0 || limit - 1 < std::uint64_t(key_t(max - min))) {
+					radix_sort::sort(begin, end, std::forward<Compare>(comp), std::move(proj), buffer);
+					return;
+				}
+
+				std::vector<std::size_t> count(std::size_t(key_t(max - min)) + 1, 0);
+				SORT_COLLECTION_INSTRUMENT_WORKSPACE(count.size() * sizeof(std::size_t));
+
+				for (auto it = begin; it != end; ++it) {
+					++count[std::size_t(key_t(encode(*it) - min))];
+				}
+
+				if constexpr ((std::is_integral_v<value_t> || std::is_enum_v<value_t>) && std::is_same_v<Projection, detail::identity>) {
+					//キーの変換は定数とのXORなので、0の変換で戻せる
+					const key_t mask = encode(value_t{});
+					auto out = begin;
+					for (std::size_t k = 0; k < count.size(); ++k) {
+						const key_t bits = key_t(key_t(min + k) ^ mask);
+						if constexpr (std::is_enum_v<value_t>) {
+							out = std::fill_n(out, count[k], static_cast<value_t>(static_cast<std::underlying_type_t<value_t>>(bits)));
+						}
+						else {
+							out = std::fill_n(out, count[k], static_cast<value_t>(bits));
+						}
+					}
+				}
+				else {
+					try {
+						buffer.reserve(N);
+					}
+					catch (const std::bad_alloc&) {
+						radix_sort::sort(begin, end, std::forward<Compare>(comp), std::move(proj), buffer);
+						return;
+					}
+
+					//各値の書き込み位置
+					std::size_t offset = 0;
+					for (auto& c : count) offset += std::exchange(c, offset);
+
+					//作業領域に構築済みの要素があるか
+					bool constructed = false;
+
+					//作業領域に構築した要素を破棄する（例外で抜けた場合も）
+					struct destroy_guard {
+						T* buffer;
+						std::size_t N;
+						const bool& constructed;
+
+						~destroy_guard() {
+							if (constructed) std::destroy(buffer, buffer + N);
+						}
+					} guard{ buffer.data(), N, constructed };
+
+					//値の位置へ作業領域に構築してから書き戻す。分配は置換になっているので各位置に1度だけ構築される
+					T* data = buffer.data();
+					for (auto it = begin; it != end; ++it) {
+						::new (static_cast<void*>(data + count[std::size_t(key_t(encode(*it) - min))]++)) T(std::move(*it));
+					}
+					constructed = true;
+
+					std::move(data, data + N, begin);
+				}
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) const {
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+			}
+		};
+
+		namespace detail {
+
+			/**
+			* @brief string_sortのキーにできる型か（charのstd::basic_stringとstd::string_view）
+			*/
+			template<typename T>
+			struct is_string_key : std::false_type {};
+
+			template<typename Allocator>
+			struct is_string_key<std::basic_string<char, std::char_traits<char>, Allocator>> : std::true_type {};
+
+			template<>
+			struct is_string_key<std::string_view> : std::true_type {};
+
+			template<typename T>
+			inline constexpr bool is_string_key_v = is_string_key<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+			/**
+			* @brief 文字列の先頭から8バイトを、整数の大小が辞書順と一致するように読む
+			* @detail 足りない分は0で埋める。0で埋めた位置と文字の'\0'は区別できないので、キャッシュが等しい時は残りの長さで比べる
+			*/
+			inline auto load_string_prefix(const unsigned char* data, std::size_t size) noexcept -> std::uint64_t {
+				if (8 <= size) {
+					std::uint64_t word;
+					std::memcpy(&word, data, 8);
+#if defined(_MSC_VER) && !defined(__clang__)
+					return _byteswap_uint64(word);
+#else
+					return __builtin_bswap64(word);
+#endif
+				}
+
+				std::uint64_t word = 0;
+				for (std::size_t i = 0; i < size; ++i) {
+					word |= std::uint64_t(data[i]) << (56 - 8 * i);
+				}
+				return word;
+			}
+
+			/**
+			* @brief string_sortが並べ替える要素
+			* @detail 文字列の位置と長さに、調べている深さからの8バイトを並べて持つ。比べるのは大抵cacheだけで済む
+			*/
+			struct string_entry {
+				//depthから8バイトのキー
+				std::uint64_t cache;
+				const unsigned char* data;
+				std::size_t size;
+				//元の位置（同値の要素の順序と、並べ替えの適用に使う）
+				std::size_t index;
+			};
+
+			/**
+			* @brief depthまでが等しいと分かっている2つの要素を比べる（同値なら元の位置で比べる）
+			* @tparam Descending 同値の要素を元の位置の逆順に並べるか（全体を後で反転する時に使う）
+			*/
+			template<bool Descending>
+			struct string_entry_less {
+				std::size_t depth;
+
+				bool operator()(const string_entry& lhs, const string_entry& rhs) const noexcept {
+					if (lhs.cache != rhs.cache) return lhs.cache < rhs.cache;
+
+					//共通の接頭辞は比べない
+					const auto order = std::string_view(reinterpret_cast<const char*>(lhs.data) + depth, lhs.size - depth).compare(std::string_view(reinterpret_cast<const char*>(rhs.data) + depth, rhs.size - depth));
+					if (order != 0) return order < 0;
+
+					return Descending ? rhs.index < lhs.index : lhs.index < rhs.index;
+				}
+			};
+
+			/**
+			* @brief これ以下の要素数では多キークイックソートせずに挿入ソートする
+			*/
+			inline constexpr std::size_t string_insertion_sort_threshold = 16;
+
+			/**
+			* @brief 多キークイックソートで分割できる回数（要素数の対数の2倍）
+			*/
+			inline auto string_sort_limit(std::size_t N) noexcept -> std::size_t {
+				std::size_t limit = 0;
+				for (; 1 < N; N >>= 1) limit += 2;
+				return limit;
+			}
+
+			/**
+			* @brief 多キークイックソートの本体
+			* @detail 8バイトのキャッシュを1文字とみなして3分割し、等しい区間だけ深さを8進めてキャッシュを読み直す
+			* @detail 偏った分割が続けば、その区間はdepthからの比較でpdqソートする。再帰するのは半分以下の区間だけなので、深さはO(log N)
+			* @param depth [begin, end)の要素が全て等しいと分かっている接頭辞の長さ
+			* @param limit 残りの分割の回数
+			*/
+			template<bool Descending>
+			void multikey_quick_sort(string_entry* begin, string_entry* end, std::size_t depth, std::size_t limit) {
+				SORT_COLLECTION_INSTRUMENT_RECURSION();
+
+				while (true) {
+					const auto N = std::size_t(end - begin);
+
+					//少なければ挿入ソート
+					if (N <= string_insertion_sort_threshold) {
+						insertion_sort::sort(begin, end, string_entry_less<Descending>{ depth });
+						return;
+					}
+
+					if (limit == 0) {
+						pdq_sort::sort(begin, end, string_entry_less<Descending>{ depth });
+						return;
+					}
+					--limit;
+
+					//3点の中央値をピボットにする
+					const auto a = begin[0].cache, b = begin[N / 2].cache, c = end[-1].cache;
+					const auto pivot = (a < b) ? ((b < c) ? b : (a < c) ? c : a) : ((a < c) ? a : (b < c) ? c : b);
+
+					//[begin, lt)はピボット未満、[lt, gt)は等しい、[gt, end)はピボットより大きい
+					auto lt = begin, gt = end;
+					for (auto it = begin; it != gt;) {
+						if (it->cache < pivot) {
+							std::swap(*lt++, *it++);
+						}
+						else if (pivot < it->cache) {
+							std::swap(*it, *--gt);
+						}
+						else {
+							++it;
+						}
+					}
+
+					//キャッシュの8バイトで終わる文字列は、それより長い文字列の接頭辞なので前に来る
+					//それらは(残りの長さ, 元の位置)で並べる。この組は重複しないので、1つの整数にして基数ソートする
+					auto longer = std::partition(lt, gt, [depth](const string_entry& e) { return e.size - depth <= 8; });
+					american_flag_sort::sort(lt, longer, std::less<>{}, [depth](const string_entry& e) {
+						return (std::uint64_t(e.size - depth) << 60) | (std::uint64_t(Descending ? ~e.index : e.index) & ((std::uint64_t(1) << 60) - 1));
+					});
+
+					//等しい区間の残りは次の8バイトで続ける
+					for (auto it = longer; it != gt; ++it) it->cache = load_string_prefix(it->data + depth + 8, it->size - depth - 8);
+					const auto next_limit = string_sort_limit(std::size_t(gt - longer));
+
+					//最も大きい区間はループで続け、残りの2つ（どちらも半分以下）を再帰する
+					const auto less_size = lt - begin, equal_size = gt - longer, greater_size = end - gt;
+					if (equal_size <= less_size && greater_size <= less_size) {
+						multikey_quick_sort<Descending>(gt, end, depth, limit);
+						multikey_quick_sort<Descending>(longer, gt, depth + 8, next_limit);
+						end = lt;
+					}
+					else if (equal_size <= greater_size) {
+						multikey_quick_sort<Descending>(begin, lt, depth, limit);
+						multikey_quick_sort<Descending>(longer, gt, depth + 8, next_limit);
+						begin = gt;
+					}
+					else {
+						multikey_quick_sort<Descending>(begin, lt, depth, limit);
+						multikey_quick_sort<Descending>(gt, end, depth, limit);
+						begin = longer;
+						end = gt;
+						depth += 8;
+						limit = next_limit;
+					}
+				}
+			}
+		}
+
+		/**
+		* @brief 文字列のソート（多キークイックソート）
+		* @detail 文字列の位置・長さと、次に比べる8バイトを整数にしたキャッシュを並べた配列をソートし、最後にその順序を範囲へ適用する
+		* @detail 比較は大抵キャッシュの整数比較だけで済み、文字列本体は深さを進める時に1度ずつ読む。既に等しいと分かった接頭辞は比べ直さない
+		* @detail 完全に等しい文字列は元の位置で並べるので安定。要素のムーブは並べ替えの適用で各要素1回程度
+		*/
+		struct string_sort {
+			static constexpr bool stable = true;
+
+			using method = detail::category::method::distribution;
+
+			/**
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素からstd::string/std::string_viewのキーを取り出す射影（要素の中を指す参照かstd::string_viewを返すこと）
+			*/
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				workspace<value_t> buffer{};
+
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj), buffer);
+			}
+
+			/**
+			* @brief 呼び出し側の作業領域を使ってソートする
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp std::less（昇順）かstd::greater（降順）
+			* @param proj 要素からstd::string/std::string_viewのキーを取り出す射影
+			* @param buffer 並べ替えの適用に使う作業領域（N要素。確保できなければ巡回置換ごとにその場で並べ替える）
+			*/
+			template<typename RandomAccessIterator, typename Compare, typename Projection, typename T, typename Allocator>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&&, Projection proj, workspace<T, Allocator>& buffer) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+				using projected_t = std::invoke_result_t<const Projection&, typename std::iterator_traits<RandomAccessIterator>::reference>;
+				using key_t = std::remove_cv_t<std::remove_reference_t<projected_t>>;
+
+				static_assert(std::is_same_v<T, value_t>, "The element type of workspace must be the value_type of the iterator.");
+				static_assert(detail::is_string_key_v<key_t>, "String sort supports only std::string and std::string_view keys.");
+				static_assert(std::is_lvalue_reference_v<projected_t> || std::is_same_v<key_t, std::string_view>, "The projection must not return a temporary string.");
+				static_assert(detail::is_standard_compare_v<Compare, value_t> || detail::is_standard_compare_v<Compare, key_t>, "String sort supports only std::less or std::greater.");
+
+				constexpr bool descending = detail::is_greater_compare_v<Compare, value_t> || detail::is_greater_compare_v<Compare, key_t>;
+
+				const auto N = std::size_t(end - begin);
+
+				if (N < 2) return;
+
+				std::vector<detail::string_entry> entries(N);
+				SORT_COLLECTION_INSTRUMENT_WORKSPACE(N * sizeof(detail::string_entry));
+
+				for (std::size_t i = 0; i < N; ++i) {
+					const std::string_view key = std::invoke(proj, begin[i]);
+					const auto data = reinterpret_cast<const unsigned char*>(key.data());
+					entries[i] = detail::string_entry{ detail::load_string_prefix(data, key.size()), data, key.size(), i };
+				}
+
+				//降順は、同値の要素を逆順に並べた昇順を反転する
+				detail::multikey_quick_sort<descending>(entries.data(), entries.data() + N, 0, detail::string_sort_limit(N));
+				if constexpr (descending) {
+					std::reverse(std::begin(entries), std::end(entries));
+				}
+
+				try {
+					buffer.reserve(N);
+				}
+				catch (const std::bad_alloc&) {
+					//巡回置換ごとにその場で並べ替える（辿り終えた位置はindexを自身にする）
+					for (std::size_t start = 0; start < N; ++start) {
+						if (entries[start].index == start) continue;
+
+						value_t tmp = std::move(begin[start]);
+						std::size_t current = start;
+						while (true) {
+							const auto source = entries[current].index;
+							entries[current].index = current;
+							if (source == start) break;
+
+							begin[current] = std::move(begin[source]);
+							current = source;
+						}
+						begin[current] = std::move(tmp);
+					}
+					return;
+				}
+
+				//ソート後の順に作業領域へムーブしてから書き戻す（読み出しだけが飛び飛びになる）
+				T* data = buffer.data();
+				std::size_t constructed = 0;
+
+				struct destroy_guard {
+					T* buffer;
+					const std::size_t& constructed;
+
+					~destroy_guard() {
+						std::destroy(buffer, buffer + constructed);
+					}
+				} guard{ data, constructed };
+
+				for (; constructed < N; ++constructed) {
+					::new (static_cast<void*>(data + constructed)) T(std::move(begin[entries[constructed].index]));
+				}
+				std::move(data, data + N, begin);
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Projection = detail::identity>
+			void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}, Projection proj = {}) const {
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+			}
+		};
+
+		/**
+		* @brief サンプルソート
+		* @detail 標本から選んだ分割値で要素をバケットへ分配し、各バケットをSortAlgorithmでソートする
+		* @detail 並列ポリシーを指定すると、分配とバケット毎のソートを共有のスレッドプールで並列に行う。逐次実行ではSortAlgorithmへそのまま委譲する
+		* @detail 分割値と同値の要素はそれだけのバケットへ集めるので、重複の多い入力でもバケットが偏らない
+		* @detail 分配はブロック毎のヒストグラムの累積和で書き込み位置を決めるので、SortAlgorithmが安定なら全体も安定
+		* @tparam SortAlgorithm 各バケットのソートに使用するアルゴリズム
+		*/
+		template<typename SortAlgorithm = pdq_sort>
+		struct sample_sort {
+			static constexpr bool stable = SortAlgorithm::stable;
+
+			using method = detail::category::method::partitioning;
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			static void sort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) {
+				SortAlgorithm::sort(begin, end, std::forward<Compare>(comp));
+			}
+
+			/**
+			* @brief 並列処理に切り替える要素数の閾値
+			* @detail 分配の単位となるブロックの大きさの下限にも使用する
+			*/
+			static inline std::size_t parallel_cutoff = 1 << 16;
+
+			/**
+			* @brief 実行ポリシーを指定してソートする
+			* @detail 要素のムーブが例外を投げうる型と、コピーできない型（分割値を取れない）は逐次実行する
+			* @param policy 実行ポリシー
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			*/
+			template<typename ExecutionPolicy, typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+			static void sort(ExecutionPolicy&&, RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				if constexpr (detail::is_parallel_policy_v<ExecutionPolicy> && std::is_nothrow_move_constructible_v<value_t> && std::is_copy_constructible_v<value_t>) {
+					if (std::size_t(end - begin) < parallel_cutoff) {
+						sort(begin, end, std::forward<Compare>(comp));
+						return;
+					}
+
+					parallel_impl(begin, end, comp, detail::thread_pool::instance());
+				}
+				else {
+					sort(begin, end, std::forward<Compare>(comp));
+				}
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			void operator()(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+			template<typename ExecutionPolicy, typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+			void operator()(ExecutionPolicy&& policy, RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) const {
+				sort(std::forward<ExecutionPolicy>(policy), begin, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			//分割値の数の上限（バケット番号をstd::uint16_tに収める）
+			static constexpr std::size_t max_splitters = 1023;
+
+			//分割値1つ当たりの標本数
+			static constexpr std::size_t oversampling = 16;
+
+			template<typename RandomAccessIterator, typename Compare>
+			static void parallel_impl(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp, detail::thread_pool& pool) {
+				using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+				const auto N = std::size_t(end - begin);
+
+				//ブロック数（スレッド数より多めに分けて、ワークスティーリングで偏りをならす）
+				const auto blocks = std::max(std::size_t(1), std::min(N / parallel_cutoff, 4 * pool.concurrency()));
+
+				//標本を取ってソートし、等間隔に分割値を選ぶ（同値の分割値は1つにまとめる）
+				const auto target_splitters = std::min(max_splitters, std::max(std::size_t(15), 8 * pool.concurrency() - 1));
+				const auto sample_size = std::min(N, (target_splitters + 1) * oversampling);
+
+				std::vector<value_t> splitters;
+				{
+					std::vector<value_t> sample;
+					sample.reserve(sample_size);
+					SORT_COLLECTION_INSTRUMENT_WORKSPACE(sample_size * sizeof(value_t));
+
+					//周期的な並びに引きずられないよう、位置は疑似乱数（xorshift）で選ぶ
+					std::uint64_t state = 0x9E3779B97F4A7C15ull ^ std::uint64_t(N);
+					for (std::size_t i = 0; i < sample_size; ++i) {
+						state ^= state << 13;
+						state ^= state >> 7;
+						state ^= state << 17;
+						sample.push_back(begin[std::size_t(state % N)]);
+					}
+
+					SortAlgorithm::sort(std::begin(sample), std::end(sample), comp);
+
+					splitters.reserve(target_splitters);
+					for (std::size_t k = 1; k <= target_splitters; ++k) {
+						const auto& candidate = sample[k * sample_size / (target_splitters + 1)];
+						if (splitters.empty() || comp(splitters.back(), candidate)) splitters.push_back(candidate);
+					}
+				}
+
+				//偶数番は分割値の間、奇数番は分割値と同値の要素のバケット
+				const auto bucket_count = 2 * splitters.size() + 1;
+
+				auto classify = [&](const value_t& value) -> std::uint16_t {
+					const auto i = std::size_t(std::upper_bound(std::begin(splitters), std::end(splitters), value, comp) - std::begin(splitters));
+					if (0 < i && comp(splitters[i - 1], value) == false) return std::uint16_t(2 * i - 1);
+					return std::uint16_t(2 * i);
+				};
+
+				auto run_parts = [&](std::size_t parts, auto& part) {
+					detail::task_group group{ pool };
+					for (std::size_t k = 1; k < parts; ++k) {
+						group.run([&part, k] { part(k); });
+					}
+					if (0 < parts) part(std::size_t(0));
+					group.wait();
+				};
+
+				//各要素のバケット番号と、ブロック毎・バケット毎の要素数
+				std::vector<std::uint16_t> bucket_of(N);
+				std::vector<std::size_t> counts(blocks * bucket_count);
+				SORT_COLLECTION_INSTRUMENT_WORKSPACE(N * sizeof(std::uint16_t) + counts.size() * sizeof(std::size_t));
+
+				auto count_block = [&](std::size_t k) {
+					const auto count = counts.data() + k * bucket_count;
+					for (auto i = N * k / blocks, last = N * (k + 1) / blocks; i < last; ++i) {
+						const auto bucket = classify(begin[i]);
+						bucket_of[i] = bucket;
+						++count[bucket];
+					}
+				};
+				run_parts(blocks, count_block);
+
+				//各バケットの範囲と、ブロック毎の書き込み開始位置（バケットの順・ブロックの順に割り当てる）
+				std::vector<std::size_t> bucket_first(bucket_count + 1);
+				std::size_t offset = 0;
+				for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+					bucket_first[bucket] = offset;
+					for (std::size_t k = 0; k < blocks; ++k) {
+						offset += std::exchange(counts[k * bucket_count + bucket], offset);
+					}
+				}
+				bucket_first[bucket_count] = N;
+
+				workspace<value_t> buffer{ N };
+				value_t* const data = buffer.data();
+
+				//作業領域へ分配する。ムーブは例外を投げないので、全要素が構築される
+				auto scatter = [&](std::size_t k) {
+					const auto count = counts.data() + k * bucket_count;
+					for (auto i = N * k / blocks, last = N * (k + 1) / blocks; i < last; ++i) {
+						::new (static_cast<void*>(data + count[bucket_of[i]]++)) value_t(std::move(begin[i]));
+					}
+				};
+				run_parts(blocks, scatter);
+
+				//作業領域の要素を破棄する（例外で抜けた場合も）
+				struct destroy_guard {
+					value_t* data;
+					std::size_t N;
+
+					~destroy_guard() {
+						std::destroy(data, data + N);
+					}
+				} guard{ data, N };
+
+				//バケット毎にソートして元の範囲へ戻す。同値のバケットはソート不要
+				auto sort_bucket = [&](std::size_t bucket) {
+					const auto first = bucket_first[bucket];
+					const auto last = bucket_first[bucket + 1];
+					if (bucket % 2 == 0 && 1 < last - first) SortAlgorithm::sort(data + first, data + last, comp);
+					std::move(data + first, data + last, begin + first);
+				};
+				run_parts(bucket_count, sort_bucket);
+			}
+		};
+
+		/**
+		* @brief 並べ替え順序（添字の列）を範囲へその場で適用する
+		* @detail 巡回置換ごとに辿るので、各要素は1度だけムーブされる（巡回ごとに一時オブジェクトへのムーブが1回加わる）
+		* @detail permutationは変更しないので、同じ順序を複数の並列な配列へ使い回せる
+		* @param begin 範囲の初め
+		* @param end 範囲の終わり
+		* @param permutation 並べ替え後のi番目に来る要素の元の位置permutation[i]（[0, N)の置換であること）
+		*/
+		template<typename RandomAccessIterator, typename Permutation>
+		void apply_permutation(RandomAccessIterator begin, RandomAccessIterator end, const Permutation& permutation) {
+			using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+			const auto N = std::size_t(end - begin);
+
+			//巡回を辿り終えた位置
+			std::vector<bool> done(N);
+			SORT_COLLECTION_INSTRUMENT_WORKSPACE((N + 7) / 8);
+
+			for (std::size_t start = 0; start < N; ++start) {
+				if (done[start]) continue;
+				done[start] = true;
+
+				std::size_t source = std::size_t(permutation[start]);
+				if (source == start) continue;
+
+				value_t tmp = std::move(begin[start]);
+				std::size_t current = start;
+				do {
+					begin[current] = std::move(begin[source]);
+					done[source] = true;
+					current = source;
+					source = std::size_t(permutation[current]);
+				} while (source != start);
+				begin[current] = std::move(tmp);
+			}
+		}
+
+		/**
+		* @brief 並べ替え順序（添字の列）をコンテナへその場で適用する
+		* @param container 並べ替えるコンテナ（::iterator = RandomAccessIteratorであること）
+		* @param permutation 並べ替え後のi番目に来る要素の元の位置permutation[i]
+		*/
+		template<typename Container, typename Permutation, std::enable_if_t<detail::is_range_v<Container>, std::nullptr_t> = nullptr>
+		void apply_permutation(Container& container, const Permutation& permutation) {
+			using std::begin;
+			using std::end;
+
+			apply_permutation(begin(container), end(container), permutation);
+		}
+
+		/**
+		* @brief auto_sortが選んだアルゴリズムの情報
+		*/
+		struct auto_sort_decision {
+			//選んだアルゴリズムの名前（整列済みで何もしない場合は"none"、逆順を反転した場合は"reverse"）
+			const char* algorithm;
+			//要素数
+			std::size_t size;
+			//安定性を要求されたか
+			bool stable;
+			//隣り合う要素を調べた組の数
+			std::size_t samples;
+			//そのうち逆順だった組の数
+			std::size_t descents;
+		};
+
+		namespace detail {
+
+			/**
+			* @brief auto_sortの選択を通知する関数
+			*/
+			inline std::atomic<void (*)(const auto_sort_decision&)> auto_sort_hook{ nullptr };
+		}
+
+		/**
+		* @brief auto_sortがアルゴリズムを選ぶ度に呼ばれる関数を設定する
+		* @param hook 呼び出す関数（nullptrで解除）
+		* @return 以前に設定されていた関数
+		*/
+		inline auto set_auto_sort_hook(void (*hook)(const auto_sort_decision&)) noexcept -> void (*)(const auto_sort_decision&) {
+			return detail::auto_sort_hook.exchange(hook);
+		}
+
+		/**
+		* @brief 入力に応じてアルゴリズムを選ぶソート
+		* @detail イテレータの種類・要素型・比較ファンクタ・安定性の要求からコンパイル時に候補を絞り、要素数と整列度合いの標本から実行時に決める
+		* @detail 少数なら挿入ソート、整列済みなら何もせず、狭義の逆順なら反転する
+		* @detail それ以外は、標準の比較で整列していない算術型には基数ソート、文字列には文字列のソート、安定性が必要ならティムソート（ほぼ整列済み）かマージソート、不要ならpdqソートを使う
+		* @detail 自明にコピーできない大きな要素は、添字を同じ基準でソートしてから1度ずつムーブする（間接ソート）
+		* @tparam Stable 安定性が必要か
+		*/
+		template<bool Stable>
+		struct basic_auto_sort {
+			static constexpr bool stable = Stable;
+
+			using method = detail::category::method::hybrid;
+
+			/**
+			* @brief 連結リストはノードを繋ぎ替えるマージソートでソートする
+			* @detail 短いリストでも要素は動かさないので、ムーブできない要素もソートできる
+			* @param list ソートするstd::listかstd::forward_list
+			* @param comp 比較に使うファンクタ
+			*/
+			template<typename List, typename Compare = std::less<typename List::value_type>, std::enable_if_t<detail::is_linked_list_v<List>, std::nullptr_t> = nullptr>
+			static void sort(List& list, Compare&& comp = Compare{}) {
+				const auto N = std::size_t(std::distance(list.begin(), list.end()));
+
+				if (auto hook = detail::auto_sort_hook.load(std::memory_order_relaxed)) {
+					hook(auto_sort_decision{ "marge_sort", N, Stable, 0, 0 });
+				}
+				marge_sort::sort(list, std::forward<Compare>(comp));
+			}
+
+			/**
+			* @detail 定数評価中は作業領域を確保できないので、pdqソート（安定性が必要なら挿入ソート）を使う
+			*/
+			template<typename ForwardIterator, typename Compare = detail::default_compare<ForwardIterator>>
+			static constexpr void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = Compare{}) {
+				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+				using category = typename std::iterator_traits<ForwardIterator>::iterator_category;
+
+				constexpr bool random_access = std::is_base_of_v<std::random_access_iterator_tag, category>;
+				constexpr bool bidirectional = std::is_base_of_v<std::bidirectional_iterator_tag, category>;
+				constexpr bool radix_sortable = random_access && (std::is_arithmetic_v<value_t> || std::is_enum_v<value_t>) && detail::is_standard_compare_v<Compare, value_t>;
+				constexpr bool string_sortable = random_access && detail::is_string_key_v<value_t> && detail::is_standard_compare_v<Compare, value_t>;
+				constexpr bool indirect_sortable = random_access && std::is_trivially_copyable_v<value_t> == false && indirect_sort_size < sizeof(value_t);
+
+				if constexpr (bidirectional) {
+					if (detail::is_constant_evaluated()) {
+						if constexpr (random_access && Stable == false) {
+							pdq_sort::sort(begin, end, comp);
+						}
+						else {
+							insertion_sort::sort(begin, end, comp);
+						}
+						return;
+					}
+				}
+
+				const auto N = std::size_t(std::distance(begin, end));
+
+				auto decide = [&](const char* algorithm, std::size_t samples = 0, std::size_t descents = 0) {
+					if (auto hook = detail::auto_sort_hook.load(std::memory_order_relaxed)) {
+						hook(auto_sort_decision{ algorithm, N, Stable, samples, descents });
+					}
+				};
+
+				if constexpr (bidirectional) {
+					if (N <= insertion_sort_threshold) {
+						decide("insertion_sort");
+						insertion_sort::sort(begin, end, comp);
+						return;
+					}
+				}
+
+				if constexpr (random_access == false) {
+					//前から辿るしかないイテレータでも、マージソートは O(N log N) で安定
+					decide("marge_sort");
+					marge_sort::sort(begin, end, comp);
+				}
+				else {
+					//等間隔に隣り合う組を調べて、逆順の組を数える
+					const auto samples = std::min<std::size_t>(probe_samples, N - 1);
+					std::size_t descents = 0;
+					for (std::size_t i = 0; i < samples; ++i) {
+						const auto pos = (N - 1) / samples * i;
+						descents += comp(begin[pos + 1], begin[pos]) ? 1 : 0;
+					}
+
+					if (descents == 0 && std::is_sorted(begin, end, comp)) {
+						decide("none", samples, descents);
+						return;
+					}
+
+					//狭義の逆順なら反転しても安定性は崩れない
+					if (descents == samples && std::adjacent_find(begin, end, [&](const value_t& lhs, const value_t& rhs) { return comp(lhs, rhs) || comp(rhs, lhs) == false; }) == end) {
+						decide("reverse", samples, descents);
+						std::reverse(begin, end);
+						return;
+					}
+
+					if constexpr (radix_sortable) {
+						//ほぼ整列済みの入力は比較ソートの方が速い
+						if (radix_sort_threshold <= N && samples / 8 < descents) {
+							decide("radix_sort", samples, descents);
+							radix_sort::sort(begin, end, comp);
+							return;
+						}
+					}
+
+					if constexpr (string_sortable) {
+						if (string_sort_threshold <= N && samples / 8 < descents) {
+							decide("string_sort", samples, descents);
+							string_sort::sort(begin, end, comp);
+							return;
+						}
+					}
+
+					if constexpr (indirect_sortable) {
+						decide("indirect_sort", samples, descents);
+						indirect_sort(begin, end, comp);
+						return;
+					}
+
+					if constexpr (Stable) {
+						//ほぼ整列済みなら既存のランを使う
+						if (descents <= samples / 8) {
+							decide("tim_sort", samples, descents);
+							tim_sort::sort(begin, end, comp);
+						}
+						else {
+							decide("marge_sort", samples, descents);
+							marge_sort::sort(begin, end, comp);
+						}
+					}
+					else {
+						decide("pdq_sort", samples, descents);
+						pdq_sort::sort(begin, end, comp);
+					}
+				}
+			}
+
+			template<typename ForwardIterator, typename Compare = detail::default_compare<ForwardIterator>>
+			constexpr void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = Compare{}) const {
+				sort(begin, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			/**
+			* @brief 添字を要素の比較でソートし、その順序を適用する
+			* @detail 添字は自明にコピーできるので、添字のソートはもう一度この中で選び直す
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static void indirect_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) {
+				std::vector<std::size_t> indices(std::size_t(end - begin));
+				std::iota(std::begin(indices), std::end(indices), std::size_t(0));
+				SORT_COLLECTION_INSTRUMENT_WORKSPACE(indices.size() * sizeof(std::size_t));
+
+				sort(std::begin(indices), std::end(indices), [begin, &comp](std::size_t lhs, std::size_t rhs) { return comp(begin[lhs], begin[rhs]); });
+				apply_permutation(begin, end, indices);
+			}
+
+			//これ以下の要素数では挿入ソートを使う
+			static constexpr std::size_t insertion_sort_threshold = 16;
+			//整列度合いを調べる組の数
+			static constexpr std::size_t probe_samples = 64;
+			//これ以上の要素数で基数ソートを使う
+			static constexpr std::size_t radix_sort_threshold = std::size_t(1) << 11;
+			//これ以上の要素数で文字列のソートを使う
+			static constexpr std::size_t string_sort_threshold = std::size_t(1) << 8;
+			//これより大きく自明にコピーできない要素は間接ソートする
+			static constexpr std::size_t indirect_sort_size = 64;
+		};
+
+		/**
+		* @brief 入力に応じてアルゴリズムを選ぶソート（安定性を要求しない）
+		*/
+		using auto_sort = basic_auto_sort<false>;
+
+		/**
+		* @brief 入力に応じてアルゴリズムを選ぶ安定ソート
+		*/
+		using stable_auto_sort = basic_auto_sort<true>;
+
+		/**
+		* @brief n番目の要素を選ぶ（イントロセレクト）
+		* @detail クイックセレクトで対象の側だけを分割していき、偏った分割が続けば中央値の中央値でピボットを選ぶ（最悪でもO(N)）
+		* @detail 終了後、nthには全体をソートした時にその位置に来る要素があり、それより前にはnth以下、後ろにはnth以上の要素が並ぶ
+		*/
+		struct nth_element {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::partitioning;
+
+			/**
+			* @param begin 範囲の初め
+			* @param nth 選ぶ位置
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			*/
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			static constexpr void select(RandomAccessIterator begin, RandomAccessIterator nth, RandomAccessIterator end, Compare&& comp = Compare{}) {
+				//イテレータ間距離の型
+				using diff_t = typename std::iterator_traits<RandomAccessIterator>::difference_type;
 
-				//要素数
-				auto N = static_cast<diff_t>(std::distance(begin, end));
+				if (nth == end) return;
 
-				if (N < diff_t(2)) return;
-				//入れ替えが起きたかどうか
-				bool is_swapped = false;
+				//偏った分割を許す回数（2 * floor(log2(N + 1))）
+				int bad_allowed = 0;
+				for (auto n = std::size_t(end - begin) + 1; 1 < n; n >>= 1) bad_allowed += 2;
 
-				//h=1のとき、交換が行われなくなるまで繰り返す
-				for (auto h = calc_h(N); diff_t(1) < h || is_swapped; h = calc_h(h)) {
-					is_swapped = false;
-					for (auto i = diff_t(0); (i + h) < N; ++i) {
-						//iの位置
-						auto&& current = std::next(begin, i);
-						//i+hの位置
-						auto&& next = std::next(current, h);
+				while (diff_t(insertion_sort_threshold) < end - begin) {
+					const auto N = end - begin;
 
-						//next < current の時入れ替え
-						//一回でもtrueが帰ればis_swappedは以降trueとなる（条件分岐回避のため、趣味）
-						is_swapped |= detail::compare_and_swap(std::move(next), std::move(current), comp);
+					if (bad_allowed <= 0) {
+						//中央値の中央値をピボットにすれば、少なくとも3割を除ける
+						median_of_medians(begin, end, comp);
+					}
+					else {
+						//3点（大きければ9点）の中央値を先頭へ
+						const auto half = N / 2;
+						if (diff_t(ninther_threshold) < N) {
+							sort3(begin, begin + half, end - 1, comp);
+							sort3(begin + 1, begin + (half - 1), end - 2, comp);
+							sort3(begin + 2, begin + (half + 1), end - 3, comp);
+							sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+						}
+						else {
+							sort3(begin, begin + half, end - 1, comp);
+						}
+						detail::iter_swap(begin, begin + half);
+					}
+
+					const auto pivot_pos = partition(begin, end, comp);
+
+					if (std::min(pivot_pos - begin, end - pivot_pos) < N / 8) --bad_allowed;
+
+					if (pivot_pos == nth) return;
+					if (nth < pivot_pos) {
+						end = pivot_pos;
+					}
+					else {
+						begin = pivot_pos + 1;
 					}
 				}
+
+				insertion_sort::sort(begin, end, comp);
 			}
 
-			template<typename ForwardIterator, typename Compare>
-			constexpr void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			constexpr void operator()(RandomAccessIterator begin, RandomAccessIterator nth, RandomAccessIterator end, Compare&& comp = Compare{}) const {
+				select(begin, nth, end, std::forward<Compare>(comp));
+			}
+
+		private:
+
+			//これ以下の要素数では挿入ソートで片付ける
+			static constexpr std::size_t insertion_sort_threshold = 16;
+			//これより多い要素数ではninther（9点の中央値）でピボットを選ぶ
+			static constexpr std::size_t ninther_threshold = 128;
+
+			/**
+			* @brief 3要素をソートする
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare& comp) {
+				detail::compare_and_swap(b, a, comp);
+				detail::compare_and_swap(c, b, comp);
+				detail::compare_and_swap(b, a, comp);
+			}
+
+			/**
+			* @brief 先頭の要素をピボットとして分割する
+			* @detail ピボットと同値の要素では両側から止まって交換するので、同値が多くても分割は偏らない
+			* @return ピボットの最終位置
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr auto partition(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) -> RandomAccessIterator {
+				const auto& pivot = *begin;
+
+				auto first = begin;
+				auto last = end;
+				while (true) {
+					do ++first; while (first != end && comp(*first, pivot));
+					do --last; while (comp(pivot, *last));
+					if (last <= first) break;
+					detail::iter_swap(first, last);
+				}
+
+				detail::iter_swap(begin, last);
+				return last;
+			}
+
+			/**
+			* @brief 5要素ずつの中央値の中央値を先頭へ置く
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			static constexpr void median_of_medians(RandomAccessIterator begin, RandomAccessIterator end, Compare& comp) {
+				const auto N = end - begin;
+
+				//各組の中央値を先頭から詰める
+				auto medians = begin;
+				for (auto group = begin; 5 <= end - group; group += 5) {
+					insertion_sort::sort(group, group + 5, comp);
+					detail::iter_swap(medians++, group + 2);
+				}
+				if (medians == begin) {
+					insertion_sort::sort(begin, end, comp);
+					detail::iter_swap(begin, begin + N / 2);
+					return;
+				}
+
+				//中央値の列の中央値
+				const auto count = medians - begin;
+				select(begin, begin + count / 2, medians, comp);
+				detail::iter_swap(begin, begin + count / 2);
 			}
 		};
 
+		/**
+		* @brief 先頭からk個だけをソートする
+		* @detail nth_elementで小さい方のk個を前に集めてから、それだけをpdqソートする（O(N + k log k)）
+		*/
+		struct partial_sort {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::partitioning;
+
+			/**
+			* @param begin 範囲の初め
+			* @param middle ソートする範囲の終わり（[begin, middle)に全体の先頭middle - begin個が整列して並ぶ）
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			*/
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			static constexpr void sort(RandomAccessIterator begin, RandomAccessIterator middle, RandomAccessIterator end, Compare&& comp = Compare{}) {
+				if (middle == begin) return;
+
+				if (middle != end) {
+					//middle - 1の要素を選べば、それより前が先頭のk個になる
+					nth_element::select(begin, std::prev(middle), end, comp);
+				}
+				pdq_sort::sort(begin, middle, comp);
+			}
+
+			template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+			constexpr void operator()(RandomAccessIterator begin, RandomAccessIterator middle, RandomAccessIterator end, Compare&& comp = Compare{}) const {
+				sort(begin, middle, end, std::forward<Compare>(comp));
+			}
+		};
 
 		/**
-		* @brief ノームソート
+		* @brief 先頭のk個を逐次的に保持する
+		* @detail 大きさkの最大ヒープ（compで最も後に並ぶ要素が根）を保ち、根より前に並ぶ要素が来た時だけ入れ替える（1要素当たりO(log k)）
+		* @detail ヒープは要素が来た分だけ伸ばすので、kが入力より大きくても保持する要素数分のメモリしか使わない
+		* @tparam T 要素型
+		* @tparam Compare 比較ファンクタ型
 		*/
-		struct gnome_sort {
-			static constexpr bool stable = true;
+		template<typename T, typename Compare = std::less<T>>
+		class top_k_accumulator {
+		public:
 
-			using method = detail::category::method::swap;
+			/**
+			* @param k 保持する要素数
+			* @param comp 比較に使うファンクタ
+			*/
+			explicit top_k_accumulator(std::size_t k, Compare comp = Compare{})
+				: m_k{ k }
+				, m_comp(std::move(comp))
+			{}
 
-			template<typename BidirectionalIterator, typename Compare>
-			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
-				
-				//終了位置
-				auto far_right = end - 1;
-				//注目位置
-				auto current = begin;
+			void push(const T& value) {
+				emplace(value);
+			}
 
-				while (current != far_right)
+			void push(T&& value) {
+				emplace(std::move(value));
+			}
+
+			/**
+			* @brief 範囲の要素を全て加える
+			*/
+			template<typename InputIterator>
+			void push(InputIterator first, InputIterator last) {
+				for (; first != last; ++first) emplace(*first);
+			}
+
+			/**
+			* @brief 保持している要素数（k以下）
+			*/
+			auto size() const noexcept -> std::size_t {
+				return m_heap.size();
+			}
+
+			/**
+			* @brief 保持している要素のうち最も後に並ぶもの（空でないこと）
+			* @detail 新しい要素はこれより前に並ぶ時だけ保持される
+			*/
+			auto threshold() const noexcept -> const T& {
+				return m_heap.front();
+			}
+
+			/**
+			* @brief 保持している要素を整列して取り出す
+			* @detail 取り出した後は空になる
+			*/
+			auto take() -> std::vector<T> {
+				std::sort_heap(m_heap.begin(), m_heap.end(), m_comp);
+				return std::exchange(m_heap, std::vector<T>{});
+			}
+
+		private:
+
+			template<typename U>
+			void emplace(U&& value) {
+				if (m_heap.size() < m_k) {
+					m_heap.push_back(std::forward<U>(value));
+					std::push_heap(m_heap.begin(), m_heap.end(), m_comp);
+				}
+				else if (m_k != 0 && m_comp(value, m_heap.front())) {
+					//根を末尾へ移して置き換え、ヒープを直す
+					std::pop_heap(m_heap.begin(), m_heap.end(), m_comp);
+					m_heap.back() = std::forward<U>(value);
+					std::push_heap(m_heap.begin(), m_heap.end(), m_comp);
+				}
+			}
+
+			std::size_t m_k;
+			Compare m_comp;
+			std::vector<T> m_heap;
+		};
+
+		/**
+		* @brief 範囲の先頭のk個を整列して取り出す
+		* @detail 入力は1度だけ先頭から読む（InputIteratorでよい）。元の範囲は変更しない
+		*/
+		struct top_k {
+			static constexpr bool stable = false;
+
+			using method = detail::category::method::select;
+
+			/**
+			* @param first 範囲の初め
+			* @param last 範囲の終わり
+			* @param k 取り出す要素数
+			* @param comp 比較に使うファンクタ
+			* @return 全体をソートした時の先頭min(k, N)個
+			*/
+			template<typename InputIterator, typename Compare = detail::default_compare<InputIterator>>
+			static auto select(InputIterator first, InputIterator last, std::size_t k, Compare comp = Compare{}) -> std::vector<typename std::iterator_traits<InputIterator>::value_type> {
+				top_k_accumulator<typename std::iterator_traits<InputIterator>::value_type, Compare> accumulator{ k, std::move(comp) };
+				accumulator.push(first, last);
+				return accumulator.take();
+			}
+
+			template<typename InputIterator, typename Compare = detail::default_compare<InputIterator>>
+			auto operator()(InputIterator first, InputIterator last, std::size_t k, Compare comp = Compare{}) const {
+				return select(first, last, k, std::move(comp));
+			}
+		};
+
+		/**
+		* @brief 要素を動かさずに、ソートした時の並び順を添字の列として求める
+		* @detail 添字だけをSortAlgorithmで並べ替えるので、大きな要素でもムーブは起こらない。結果はapply_permutation()で適用できる
+		* @tparam SortAlgorithm 添字のソートに使用するアルゴリズム（安定なら同値の要素は元の順に並ぶ）
+		* @param begin 範囲の初め
+		* @param end 範囲の終わり
+		* @param comp 比較に使うファンクタ
+		* @return 並べ替え後のi番目に来る要素の元の位置を並べたもの
+		*/
+		template<typename SortAlgorithm, typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>>
+		auto argsort(RandomAccessIterator begin, RandomAccessIterator end, Compare&& comp = Compare{}) -> std::vector<std::size_t> {
+			std::vector<std::size_t> indices(std::size_t(end - begin));
+			std::iota(std::begin(indices), std::end(indices), std::size_t(0));
+			SORT_COLLECTION_INSTRUMENT_WORKSPACE(indices.size() * sizeof(std::size_t));
+
+			if constexpr (std::is_same_v<typename SortAlgorithm::method, detail::category::method::distribution>) {
+				//分布数え上げソートには要素への射影として渡す
+				SortAlgorithm::sort(std::begin(indices), std::end(indices), comp, [begin](std::size_t i) -> decltype(auto) { return begin[i]; });
+			}
+			else {
+				SortAlgorithm::sort(std::begin(indices), std::end(indices), [begin, &comp](std::size_t lhs, std::size_t rhs) { return comp(begin[lhs], begin[rhs]); });
+			}
+
+			return indices;
+		}
+
+		/**
+		* @brief 要素を動かさずに、コンテナをソートした時の並び順を添字の列として求める
+		* @tparam SortAlgorithm 添字のソートに使用するアルゴリズム
+		* @param container 対象のコンテナ（::iterator = RandomAccessIteratorであること）
+		* @param comp 比較に使うファンクタ
+		* @return 並べ替え後のi番目に来る要素の元の位置を並べたもの
+		*/
+		template<typename SortAlgorithm, typename Container, typename Compare = detail::default_compare<decltype(std::begin(std::declval<const Container&>()))>, std::enable_if_t<detail::is_range_v<Container>, std::nullptr_t> = nullptr>
+		auto argsort(const Container& container, Compare&& comp = Compare{}) -> std::vector<std::size_t> {
+			using std::begin;
+			using std::end;
+
+			return argsort<SortAlgorithm>(begin(container), end(container), std::forward<Compare>(comp));
+		}
+
+		/**
+		* @brief キーを1度だけ計算してからソートする（Schwartzian transform）
+		* @detail 射影したキーと元の位置の組を連続したバッファへ作ってSortAlgorithmで並べ替え、最後にその順序を元の範囲へ適用する
+		* @detail 射影は要素ごとに1回しか呼ばれないので、キーの計算が比較より重い時に使う
+		* @tparam SortAlgorithm (キー, 位置)の組のソートに使用するアルゴリズム
+		*/
+		template<typename SortAlgorithm>
+		struct cached_key_sort {
+			static constexpr bool stable = SortAlgorithm::stable;
+
+			using method = typename SortAlgorithm::method;
+
+			/**
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp キーの比較に使うファンクタ
+			* @param proj 要素からキーを計算する射影
+			*/
+			template<typename ForwardIterator, typename Compare = std::less<>, typename Projection = detail::identity>
+			static void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = Compare{}, Projection proj = {}) {
+				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+				using key_t = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<Projection&, typename std::iterator_traits<ForwardIterator>::reference>>>;
+				using entry_t = entry<key_t>;
+
+				std::vector<entry_t> entries;
+				entries.reserve(std::size_t(std::distance(begin, end)));
+				for (auto it = begin; it != end; ++it) entries.push_back(entry_t{ std::invoke(proj, *it), entries.size() });
+				SORT_COLLECTION_INSTRUMENT_WORKSPACE(entries.size() * sizeof(entry_t));
+
+				if (entries.size() < 2) return;
+
+				if constexpr (std::is_same_v<method, detail::category::method::distribution>) {
+					//分布数え上げソートにはキーへの射影として渡す
+					SortAlgorithm::sort(std::begin(entries), std::end(entries), comp, [](const entry_t& e) -> const key_t& { return e.key; });
+				}
+				else {
+					SortAlgorithm::sort(std::begin(entries), std::end(entries), [&comp](const entry_t& lhs, const entry_t& rhs) { return comp(lhs.key, rhs.key); });
+				}
+
+				//ソート後の順に並べ直す
+				if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<ForwardIterator>::iterator_category>) {
+					std::vector<std::size_t> permutation;
+					permutation.reserve(entries.size());
+					for (const auto& e : entries) permutation.push_back(e.index);
+					entries = std::vector<entry_t>{};
+
+					apply_permutation(begin, end, permutation);
+				}
+				else {
+					std::vector<value_t> values;
+					values.reserve(entries.size());
+					for (auto it = begin; it != end; ++it) values.push_back(std::move(*it));
+					SORT_COLLECTION_INSTRUMENT_WORKSPACE(values.size() * sizeof(value_t));
+
+					for (const auto& e : entries) *begin++ = std::move(values[e.index]);
+				}
+			}
+
+			template<typename ForwardIterator, typename Compare = std::less<>, typename Projection = detail::identity>
+			void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = Compare{}, Projection proj = {}) const {
+				sort(begin, end, std::forward<Compare>(comp), std::move(proj));
+			}
+
+		private:
+
+			/**
+			* @brief 計算済みのキーと元の位置
+			*/
+			template<typename Key>
+			struct entry {
+				Key key;
+				std::size_t index;
+			};
+		};
+
+		/**
+		* @brief ソート済みの範囲の後ろに追加された要素をソートし、既存の範囲へマージする
+		* @detail 追加分[middle, end)だけをSortAlgorithmでソートしてmarge_sort::merge()でマージするので、全体をソートし直さずO(n + k log k)で済む
+		* @detail 追加分の最小要素以下の既存要素と、既存の最大要素以上の追加分は動かさない。既存の要素と同値の追加分は既存の要素の後ろに並ぶ
+		* @tparam SortAlgorithm 追加分のソートに使用するアルゴリズム
+		* @param begin ソート済みの範囲の初め
+		* @param middle ソート済みの範囲の終わり（追加分の初め）
+		* @param end 追加分の終わり
+		* @param comp 比較に使うファンクタ
+		* @param buffer マージの作業領域（同じ作業領域を使い回せば、更新のたびに確保が起きない）
+		*/
+		template<typename SortAlgorithm, typename BidirectionalIterator, typename Compare, typename T, typename Allocator>
+		void merge_insert(BidirectionalIterator begin, BidirectionalIterator middle, BidirectionalIterator end, Compare&& comp, workspace<T, Allocator>& buffer) {
+			if (middle == end) return;
+
+			SortAlgorithm::sort(middle, end, comp);
+
+			if (begin == middle) return;
+
+			//追加分の最小要素より大きい既存要素から後ろだけが動く
+			auto first = std::upper_bound(begin, middle, *middle, comp);
+			//既存の最大要素以上の追加分は既に正しい位置にある
+			auto last = std::lower_bound(middle, end, *std::prev(middle), comp);
+
+			marge_sort::merge(first, middle, last, comp, buffer);
+		}
+
+		/**
+		* @brief ソート済みの範囲の後ろに追加された要素をソートし、既存の範囲へマージする
+		* @tparam SortAlgorithm 追加分のソートに使用するアルゴリズム
+		* @param begin ソート済みの範囲の初め
+		* @param middle ソート済みの範囲の終わり（追加分の初め）
+		* @param end 追加分の終わり
+		* @param comp 比較に使うファンクタ
+		*/
+		template<typename SortAlgorithm, typename BidirectionalIterator, typename Compare = detail::default_compare<BidirectionalIterator>>
+		void merge_insert(BidirectionalIterator begin, BidirectionalIterator middle, BidirectionalIterator end, Compare&& comp = Compare{}) {
+			using value_t = typename std::iterator_traits<BidirectionalIterator>::value_type;
+
+			workspace<value_t> buffer{};
+
+			merge_insert<SortAlgorithm>(begin, middle, end, std::forward<Compare>(comp), buffer);
+		}
+
+		/**
+		* @brief ソート済みのコンテナの末尾へ要素を追加し、ソートされた状態を保つ
+		* @tparam SortAlgorithm 追加分のソートに使用するアルゴリズム
+		* @param container ソート済みのコンテナ（insert()を持ち、::iterator = BidirectionalIteratorであること）
+		* @param first 追加する要素の初め
+		* @param last 追加する要素の終わり
+		* @param comp 比較に使うファンクタ
+		* @param buffer マージの作業領域
+		*/
+		template<typename SortAlgorithm, typename Container, typename InputIterator, typename Compare, typename T, typename Allocator>
+		void sorted_append(Container& container, InputIterator first, InputIterator last, Compare&& comp, workspace<T, Allocator>& buffer) {
+			using std::begin;
+			using std::end;
+
+			const auto old_size = std::distance(begin(container), end(container));
+			container.insert(end(container), first, last);
+
+			auto head = begin(container);
+			merge_insert<SortAlgorithm>(head, std::next(head, old_size), end(container), std::forward<Compare>(comp), buffer);
+		}
+
+		/**
+		* @brief ソート済みのコンテナの末尾へ要素を追加し、ソートされた状態を保つ
+		* @tparam SortAlgorithm 追加分のソートに使用するアルゴリズム
+		* @param container ソート済みのコンテナ（insert()を持ち、::iterator = BidirectionalIteratorであること）
+		* @param first 追加する要素の初め
+		* @param last 追加する要素の終わり
+		* @param comp 比較に使うファンクタ
+		*/
+		template<typename SortAlgorithm, typename Container, typename InputIterator, typename Compare = std::less<typename Container::value_type>>
+		void sorted_append(Container& container, InputIterator first, InputIterator last, Compare&& comp = Compare{}) {
+			workspace<typename Container::value_type> buffer{};
+
+			sorted_append<SortAlgorithm>(container, first, last, std::forward<Compare>(comp), buffer);
+		}
+
+		namespace detail {
+
+			/**
+			* @brief 敗者木
+			* @detail k個の列の先頭のうち最も前に並ぶもの（勝者）を、先頭が進む毎にceil(log2 k)回の比較で求め直す
+			* @detail 内部節点にはそこでの試合の敗者を置くので、勝者の葉から根までの敗者とだけ比べ直せばよい（ヒープは1段毎に2回比べる）
+			* @tparam Beats (i, j) -> bool：列iが列jに勝つか。尽きた列は常に負け、同値は番号の小さい列が勝つようにすれば、マージは安定になる
+			*/
+			template<typename Beats>
+			class loser_tree {
+			public:
+
+				/**
+				* @param k 列の数（1以上）
+				* @param beats 列同士の勝敗を決める関数
+				*/
+				loser_tree(std::size_t k, Beats beats)
+					: m_k{ k }
+					, m_leaves{ leaf_count(k) }
+					, m_tree(m_leaves)
+					, m_beats(std::move(beats))
 				{
-					//current < current + 1　次の要素と比較
-					if (detail::compare_and_swap(current + 1, current, comp) == true) {
-						//入れ替えが起きていたら
-						if (current != begin) {
-							//一つ戻って比較
-							--current;
+					//葉から順に試合をして、各節点に敗者、m_tree[0]に勝者を置く
+					std::vector<std::size_t> winners(2 * m_leaves);
+					for (std::size_t i = 0; i < m_leaves; ++i) winners[m_leaves + i] = i;
+					for (auto node = m_leaves - 1; 0 < node; --node) {
+						const auto lhs = winners[2 * node];
+						const auto rhs = winners[2 * node + 1];
+						const bool left_wins = beats_or_padding(lhs, rhs);
+						winners[node] = left_wins ? lhs : rhs;
+						m_tree[node] = left_wins ? rhs : lhs;
+					}
+					m_tree[0] = winners[1];
+				}
+
+				/**
+				* @brief 勝者の列の番号
+				*/
+				auto winner() const noexcept -> std::size_t {
+					return m_tree[0];
+				}
+
+				/**
+				* @brief 勝者の列の先頭が変わった（進んだか尽きた）後に、勝者を求め直す
+				*/
+				void replay() {
+					auto winner = m_tree[0];
+					for (auto node = (m_leaves + winner) / 2; 0 < node; node /= 2) {
+						if (beats_or_padding(m_tree[node], winner)) std::swap(m_tree[node], winner);
+					}
+					m_tree[0] = winner;
+				}
+
+			private:
+
+				//葉の数（k以上の2の冪）
+				static auto leaf_count(std::size_t k) noexcept -> std::size_t {
+					std::size_t leaves = 1;
+					while (leaves < k) leaves *= 2;
+					return leaves;
+				}
+
+				//k以上の番号の葉は、常に負ける空の列
+				auto beats_or_padding(std::size_t lhs, std::size_t rhs) -> bool {
+					if (m_k <= rhs) return true;
+					if (m_k <= lhs) return false;
+					return m_beats(lhs, rhs);
+				}
+
+				std::size_t m_k;
+				std::size_t m_leaves;
+				std::vector<std::size_t> m_tree;
+				Beats m_beats;
+			};
+
+			template<typename T>
+			struct is_iterator_pair : std::false_type {};
+
+			template<typename Iterator>
+			struct is_iterator_pair<std::pair<Iterator, Iterator>> : std::true_type {};
+
+			/**
+			* @brief 列（コンテナか、イテレータの組）の範囲を取り出す
+			*/
+			template<typename Sequence>
+			auto sequence_bounds(Sequence& sequence) {
+				if constexpr (is_iterator_pair<std::remove_cv_t<Sequence>>::value) {
+					return std::make_pair(sequence.first, sequence.second);
+				}
+				else {
+					using std::begin;
+					using std::end;
+					return std::make_pair(begin(sequence), end(sequence));
+				}
+			}
+
+			/**
+			* @brief 列を指すイテレータから、列の要素を指すイテレータの型を求める
+			*/
+			template<typename SequenceIterator>
+			using sequence_element_iterator_t = decltype(sequence_bounds(*std::declval<SequenceIterator>()).first);
+
+			/**
+			* @brief multiway_mergeを並列処理に切り替える要素数の閾値
+			*/
+			inline constexpr std::size_t multiway_merge_parallel_cutoff = std::size_t(1) << 16;
+
+			/**
+			* @brief 列の組を敗者木でマージする
+			* @detail 同値の要素は前の列のものが先に並ぶ。空の列は先に除く
+			*/
+			template<typename Iterator, typename OutputIterator, typename Compare>
+			auto multiway_merge_impl(std::vector<std::pair<Iterator, Iterator>>& sequences, OutputIterator out, Compare& comp) -> OutputIterator {
+				sequences.erase(std::remove_if(std::begin(sequences), std::end(sequences), [](const auto& sequence) { return sequence.first == sequence.second; }), std::end(sequences));
+
+				switch (sequences.size()) {
+				case 0:
+					return out;
+				case 1:
+					return std::copy(sequences[0].first, sequences[0].second, out);
+				case 2:
+					//std::mergeも同値は1つ目の列が先
+					return std::merge(sequences[0].first, sequences[0].second, sequences[1].first, sequences[1].second, out, comp);
+				default:
+					break;
+				}
+
+				//i < jなら同値でiが勝つので、比較は1回で済む
+				auto beats = [&sequences, &comp](std::size_t i, std::size_t j) {
+					const auto& lhs = sequences[i];
+					const auto& rhs = sequences[j];
+					if (lhs.first == lhs.second) return false;
+					if (rhs.first == rhs.second) return true;
+					return (i < j) ? comp(*rhs.first, *lhs.first) == false : comp(*lhs.first, *rhs.first);
+				};
+
+				loser_tree<decltype(beats)> tree{ sequences.size(), beats };
+
+				while (true) {
+					auto& sequence = sequences[tree.winner()];
+					if (sequence.first == sequence.second) break;
+
+					*out = *sequence.first;
+					++out;
+					++sequence.first;
+					tree.replay();
+				}
+				return out;
+			}
+
+			/**
+			* @brief 複数のソート済みの列を合わせた中で、先頭からrank個の要素が各列から何個ずつ来るかを求める（multi-sequence selection）
+			* @detail 要素は(値, 列の番号, 列内の位置)の順に並ぶものとする。最も広い候補の区間の中央の要素の順位を二分探索で数え、全ての列の候補の区間を狭めていく
+			* @return 各列の分割位置（合計がrank）
+			*/
+			template<typename RandomAccessIterator, typename Compare>
+			auto multisequence_select(const std::vector<std::pair<RandomAccessIterator, RandomAccessIterator>>& sequences, std::size_t rank, Compare& comp) -> std::vector<std::size_t> {
+				const auto k = sequences.size();
+
+				std::size_t total = 0;
+				for (auto& sequence : sequences) total += std::size_t(sequence.second - sequence.first);
+
+				//分割位置は[low, high]にある
+				std::vector<std::size_t> low(k), high(k), position(k);
+				for (std::size_t j = 0; j < k; ++j) {
+					const auto size = std::size_t(sequences[j].second - sequences[j].first);
+					high[j] = std::min(size, rank);
+					low[j] = (total - size < rank) ? rank - (total - size) : 0;
+				}
+
+				while (true) {
+					std::size_t i = 0;
+					for (std::size_t j = 1; j < k; ++j) {
+						if (high[i] - low[i] < high[j] - low[j]) i = j;
+					}
+					if (high[i] == low[i]) return low;
+
+					//列iのmiddle番目の要素の前に並ぶ要素数
+					const auto middle = low[i] + (high[i] - low[i]) / 2;
+					const auto& pivot = sequences[i].first[middle];
+					std::size_t before = 0;
+					for (std::size_t j = 0; j < k; ++j) {
+						const auto [first, last] = sequences[j];
+						if (j < i) {
+							position[j] = std::size_t(std::upper_bound(first, last, pivot, comp) - first);
+						}
+						else if (i < j) {
+							position[j] = std::size_t(std::lower_bound(first, last, pivot, comp) - first);
 						}
 						else {
-							//左端の時は進む
-							++current;
+							position[j] = middle;
 						}
+						before += position[j];
+					}
+
+					if (before == rank) return position;
+
+					if (before < rank) {
+						//pivotまでは全て先頭rank個に入る
+						for (std::size_t j = 0; j < k; ++j) low[j] = std::max(low[j], position[j]);
+						low[i] = middle + 1;
+					}
+					else {
+						for (std::size_t j = 0; j < k; ++j) high[j] = std::min(high[j], position[j]);
+					}
+				}
+			}
+		}
+
+		/**
+		* @brief 複数のソート済みの列をマージする
+		* @detail 敗者木で毎回の最小を選ぶので、k個の列の合計n要素をO(n log k)の比較と、要素1つ当たり1回のコピーでマージする（2つずつ繰り返しマージすると、各要素がlog k回移動する）
+		* @detail 同値の要素は前の列のものが先に並ぶ（安定）。要素はコピーされ、入力は変更しない
+		* @param first 列の並びの初め（列はコンテナか、std::pair<Iterator, Iterator>）
+		* @param last 列の並びの終わり
+		* @param out 出力先（入力の列と重なっていないこと）
+		* @param comp 比較に使うファンクタ
+		* @return 出力の終わり
+		* @code
+		* std::vector<std::vector<int>> shards = collect();
+		* std::vector<int> merged;
+		* sort_collection::multiway_merge(std::begin(shards), std::end(shards), std::back_inserter(merged));
+		* @endcode
+		*/
+		template<typename SequenceIterator, typename OutputIterator, typename Compare = detail::default_compare<detail::sequence_element_iterator_t<SequenceIterator>>, std::enable_if_t<!detail::is_execution_policy_v<SequenceIterator>, std::nullptr_t> = nullptr>
+		auto multiway_merge(SequenceIterator first, SequenceIterator last, OutputIterator out, Compare comp = Compare{}) -> OutputIterator {
+			using iterator = detail::sequence_element_iterator_t<SequenceIterator>;
+
+			std::vector<std::pair<iterator, iterator>> sequences;
+			for (; first != last; ++first) sequences.push_back(detail::sequence_bounds(*first));
+
+			return detail::multiway_merge_impl(sequences, out, comp);
+		}
+
+		/**
+		* @brief 実行ポリシーを指定して、複数のソート済みの列をマージする
+		* @detail 並列実行では、出力を等分する位置をmulti-sequence selectionで各列について求め、分けた部分をそれぞれ敗者木でマージする
+		* @detail 列の要素と出力先がRandomAccessIteratorでなければ逐次実行する
+		* @param policy 実行ポリシー
+		* @param first 列の並びの初め（列はコンテナか、std::pair<Iterator, Iterator>）
+		* @param last 列の並びの終わり
+		* @param out 出力先（入力の列と重なっていないこと）
+		* @param comp 比較に使うファンクタ
+		* @return 出力の終わり
+		*/
+		template<typename ExecutionPolicy, typename SequenceIterator, typename OutputIterator, typename Compare = detail::default_compare<detail::sequence_element_iterator_t<SequenceIterator>>, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+		auto multiway_merge(ExecutionPolicy&&, SequenceIterator first, SequenceIterator last, OutputIterator out, Compare comp = Compare{}) -> OutputIterator {
+			using iterator = detail::sequence_element_iterator_t<SequenceIterator>;
+
+			std::vector<std::pair<iterator, iterator>> sequences;
+			for (; first != last; ++first) sequences.push_back(detail::sequence_bounds(*first));
+
+			if constexpr (detail::is_parallel_policy_v<ExecutionPolicy> && detail::is_random_access_iterator_v<iterator> && detail::is_random_access_iterator_v<OutputIterator>) {
+				std::size_t total = 0;
+				for (auto& sequence : sequences) total += std::size_t(sequence.second - sequence.first);
+
+				auto& pool = detail::thread_pool::instance();
+				const auto parts = std::max(std::size_t(1), std::min(total / detail::multiway_merge_parallel_cutoff, 4 * pool.concurrency()));
+				if (parts == 1 || sequences.size() < 2) return detail::multiway_merge_impl(sequences, out, comp);
+
+				auto run_parts = [&pool](std::size_t count, auto& part) {
+					detail::task_group group{ pool };
+					for (std::size_t p = 1; p < count; ++p) {
+						group.run([&part, p] { part(p); });
 					}
-					else {
-						//入れ替えが起きなかったら
-						++current;
+					part(std::size_t(0));
+					group.wait();
+				};
+
+				//部分pは出力の[total * p / parts, total * (p + 1) / parts)
+				std::vector<std::vector<std::size_t>> splits(parts + 1);
+				auto select_part = [&](std::size_t p) {
+					splits[p] = detail::multisequence_select(sequences, total * p / parts, comp);
+				};
+				run_parts(parts, select_part);
+				for (auto& sequence : sequences) splits[parts].push_back(std::size_t(sequence.second - sequence.first));
+
+				auto merge_part = [&](std::size_t p) {
+					std::vector<std::pair<iterator, iterator>> pieces;
+					pieces.reserve(sequences.size());
+					for (std::size_t j = 0; j < sequences.size(); ++j) {
+						pieces.emplace_back(sequences[j].first + splits[p][j], sequences[j].first + splits[p + 1][j]);
 					}
-				}
+					detail::multiway_merge_impl(pieces, out + (total * p / parts), comp);
+				};
+				run_parts(parts, merge_part);
+
+				return out + total;
+			}
+			else {
+				return detail::multiway_merge_impl(sequences, out, comp);
 			}
+		}
 
-			template<typename BidirectionalIterator, typename Compare>
-			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
+		/**
+		* @brief incremental_sortの進み具合と、一度にソートした場合と比べた余分な仕事の量
+		*/
+		struct incremental_sort_stats {
+			//行った操作の数（要素の移動・交換と、ラン作成時の比較）
+			std::size_t operations = 0;
+			//そのうち一度にソートすれば要らなかったもの（中断時の書き戻しと再退避、作業領域に収まらないマージの回転）
+			std::size_t overhead_operations = 0;
+			//スライス（step()、step_for()、step_until()、finish()の呼び出し）の数
+			std::size_t slices = 0;
+			//スライスの中で費やした時間の合計
+			std::chrono::nanoseconds elapsed{};
+
+			/**
+			* @brief 一度にソートした場合の操作数に対する余分な操作数の割合
+			*/
+			auto overhead_ratio() const noexcept -> double {
+				const auto required = operations - overhead_operations;
+				return (required == 0) ? 0.0 : double(overhead_operations) / double(required);
 			}
 		};
 
 		/**
-		* @brief 選択ソート
+		* @brief 少しずつ進められる安定ソート
+		* @detail ボトムアップのマージソートを、操作数か期限で区切ったスライスごとに進める。スライスの間はマージの幅と位置、分けたマージの残りを保持する
+		* @detail スライスの間、範囲には全ての要素がちょうど1つずつ並んでいるので、いつでも読み出せる（全体が整列するのはdone()がtrueになってから）。途中で範囲を書き換えてはいけない
+		* @detail マージは短い側を作業領域へ退避して行い、スライスの終わりでは退避している残りを範囲へ書き戻す
+		* @detail 短い側が作業領域（max_buffer要素、step()では操作数の上限も超えない）より長いマージは、交換だけで行う回転で分けてから行う。これによりスライスの超過は作業領域の大きさ程度の操作に収まる
+		* @tparam RandomAccessIterator 範囲のイテレータ
+		* @tparam Compare 比較ファンクタ型
+		* @tparam Allocator 作業領域のアロケータ
 		*/
-		struct selection_sort {
-			static constexpr bool stable = false;
+		template<typename RandomAccessIterator, typename Compare = detail::default_compare<RandomAccessIterator>, typename Allocator = std::allocator<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+		class incremental_sort {
+			using value_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
 
-			using method = detail::category::method::select;
+		public:
 
-			template<typename ForwardIterator, typename Compare>
-			static constexpr void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) {
-				//範囲の右端
-				auto far_right = end - 1;
+			//max_bufferの既定値
+			static constexpr std::size_t default_max_buffer = std::size_t(1) << 16;
 
-				if (begin == far_right) return;
+			/**
+			* @param begin 範囲の初め
+			* @param end 範囲の終わり
+			* @param comp 比較に使うファンクタ
+			* @param max_buffer 作業領域の最大要素数（スライスの終わりに書き戻す量の上限）
+			* @param alloc 作業領域の確保に使うアロケータ
+			*/
+			incremental_sort(RandomAccessIterator begin, RandomAccessIterator end, Compare comp = Compare{}, std::size_t max_buffer = default_max_buffer, const Allocator& alloc = Allocator())
+				: m_begin{ begin }
+				, m_size{ std::size_t(end - begin) }
+				, m_comp(std::move(comp))
+				, m_max_buffer{ std::max<std::size_t>(max_buffer, 1) }
+				, m_buffer(alloc)
+				, m_done{ m_size < 2 }
+			{}
 
-				for (auto current = begin; current != far_right; ++current) {
-					using std::swap;
+			/**
+			* @brief およそoperations回の操作だけソートを進める
+			* @return 全体が整列したか
+			*/
+			auto step(std::size_t operations) -> bool {
+				slice(std::max(operations, run_size), [&] { advance(operations); });
+				return m_done;
+			}
 
-					//一番小さい要素を探す
-					auto min_it = std::min_element(current, end, comp);
-					//それがcurrentがでなければ入れ替え
-					if (min_it != current) swap(*min_it, *current);
-				}
+			/**
+			* @brief 期限までソートを進める
+			* @return 全体が整列したか
+			*/
+			template<typename Clock, typename Duration>
+			auto step_until(const std::chrono::time_point<Clock, Duration>& deadline) -> bool {
+				slice(m_max_buffer, [&] {
+					while (m_done == false && Clock::now() < deadline) advance(deadline_check_interval);
+				});
+				return m_done;
 			}
 
-			template<typename ForwardIterator, typename Compare>
-			constexpr void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
+			/**
+			* @brief 指定した時間だけソートを進める
+			* @return 全体が整列したか
+			*/
+			template<typename Rep, typename Period>
+			auto step_for(const std::chrono::duration<Rep, Period>& budget) -> bool {
+				return step_until(std::chrono::steady_clock::now() + budget);
 			}
-		};
 
-		struct insertion_sort {
-			static constexpr bool stable = true;
+			/**
+			* @brief 残りを全て終わらせる
+			*/
+			void finish() {
+				slice(m_max_buffer, [&] {
+					while (m_done == false) advance(std::numeric_limits<std::size_t>::max());
+				});
+			}
 
-			using method = detail::category::method::insert;
+			/**
+			* @brief 全体が整列したか
+			*/
+			auto done() const noexcept -> bool {
+				return m_done;
+			}
 
-			template<typename BidirectionalIterator, typename Compare>
-			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
-				auto far_right = end - 1;
+			/**
+			* @brief これまでの操作数、余分な操作数、スライス数、経過時間
+			*/
+			auto stats() const noexcept -> const incremental_sort_stats& {
+				return m_stats;
+			}
 
-				//先頭と次をとりあえず比較し入れ替え
-				detail::compare_and_swap(begin + 1, begin, comp);
+		private:
 
-				//3番目の要素から
-				for (auto current = begin + 2; curent != far_right; ++current) {
-					//一つ左の要素
-					auto prev = current - 1;
+			//挿入ソートで作る最初のランの長さ
+			static constexpr std::size_t run_size = 32;
+			//期限付きのスライスで時刻を確かめる間隔（操作数）
+			static constexpr std::size_t deadline_check_interval = 4096;
 
-					//正順であれば次へ
-					if (comp(*prev, *current) == true) continue;
+			/**
+			* @brief 残っているマージか回転
+			* @detail 回転はGries-Millsのブロック交換で行い、progressは交換中のブロックの何要素目まで進んだか
+			*/
+			struct task {
+				bool rotate;
+				std::size_t first;
+				std::size_t middle;
+				std::size_t last;
+				std::size_t progress;
+			};
 
-					//nextの要素をコピー
-					auto tmp = std::move(*current);
+			/**
+			* @brief 作業領域を使っている最中のマージ（末尾のタスクのもの）
+			* @detail forwardなら[buffer_head, buffer_end)が退避した左側の残り、headが右側の残りの先頭、outが次の書き込み位置
+			* @detail そうでなければ[作業領域の先頭, buffer_head)が退避した右側の残り、headが左側の残りの終わり、outが書き込んだ位置の先頭
+			*/
+			struct active_merge {
+				bool forward;
+				std::size_t first;
+				std::size_t last;
+				std::size_t out;
+				std::size_t head;
+				value_t* buffer_head;
+				value_t* buffer_end;
+			};
 
-					//挿入位置を探す
-					do {
-						*(prev + 1) = std::move(*prev);
-						--prev;
-						//prevが先頭でなく、tmp < prevである間ループ
-					} while (prev != begin && comp(tmp, *prev));
-					//挿入
-					*prev = std::move(tmp);
-				}
+			/**
+			* @brief 1つのスライスを実行し、終わりに作業領域の中身を範囲へ書き戻す
+			* @detail 例外で抜けた場合も書き戻すので、範囲に抜けは残らない
+			* @param buffer_limit このスライスで始めるマージが作業領域へ退避してよい要素数
+			*/
+			template<typename F>
+			void slice(std::size_t buffer_limit, F&& f) {
+				struct slice_guard {
+					incremental_sort& self;
+					std::chrono::steady_clock::time_point start;
+
+					~slice_guard() {
+						self.suspend();
+						self.m_stats.elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+					}
+				} guard{ *this, std::chrono::steady_clock::now() };
+
+				++m_stats.slices;
+				m_buffer_limit = buffer_limit;
+				f();
 			}
 
-			template<typename BidirectionalIterator, typename Compare>
-			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
+			/**
+			* @brief budget回の操作に達するか終わるまで、ランの作成かマージを進める
+			*/
+			void advance(std::size_t budget) {
+				std::size_t used = 0;
+
+				while (used < budget && m_done == false) {
+					std::size_t count = 0;
+
+					if (m_width == 0) {
+						count = make_run();
+					}
+					else if (m_tasks.empty()) {
+						if (m_size <= m_width) {
+							m_done = true;
+							break;
+						}
+
+						//次の隣り合うランの組
+						const auto first = m_position;
+						const auto middle = std::min(first + m_width, m_size);
+						const auto last = std::min(middle + m_width, m_size);
+						if (middle != last) m_tasks.push_back(task{ false, first, middle, last, 0 });
+						if (last == m_size) {
+							m_position = 0;
+							m_width *= 2;
+						}
+						else {
+							m_position = last;
+						}
+					}
+					else {
+						count = m_tasks.back().rotate ? rotate(budget - used) : merge(budget - used);
+					}
+
+					used += count;
+					m_stats.operations += count;
+				}
 			}
-		};
 
-		/**
-		* @brief シェルソート
-		*/
-		struct shell_sort {
-			static constexpr bool stable = false;
+			/**
+			* @brief 次のランを挿入ソートで作る
+			* @return 比較の回数
+			*/
+			auto make_run() -> std::size_t {
+				const auto first = m_position;
+				const auto last = std::min(first + run_size, m_size);
 
-			using method = detail::category::method::insert;
+				std::size_t comparisons = 0;
+				insertion_sort::sort(m_begin + first, m_begin + last, [this, &comparisons](const auto& lhs, const auto& rhs) {
+					++comparisons;
+					return m_comp(lhs, rhs);
+				});
 
-			template<typename BidirectionalIterator, typename Compare>
-			static constexpr void sort(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) {
-				//イテレータ間距離の型
-				using diff_t = typename std::iterator_traits<BidirectionalIterator>::difference_type;
+				m_position = last;
+				if (m_position == m_size) {
+					m_width = run_size;
+					m_position = 0;
+					m_buffer.reserve(std::min(m_max_buffer, (m_size + 1) / 2));
+				}
+				return comparisons;
+			}
 
-				//h = (h - 1)/3 を求める
-				constexpr auto calc_h = [](const diff_t N) -> diff_t { return (N - 1) / 3; };
+			/**
+			* @brief 末尾のマージを進める
+			* @detail 短い側が作業領域に収まらなければ、回転と2つのマージに分ける
+			* @return 行った操作数
+			*/
+			auto merge(std::size_t budget) -> std::size_t {
+				if (m_merging) {
+					return m_merge.forward ? merge_forward(budget) : merge_backward(budget);
+				}
 
-				//要素数
-				auto N = static_cast<diff_t>(std::distance(begin, end));
+				auto first = m_tasks.back().first;
+				const auto middle = m_tasks.back().middle;
+				auto last = m_tasks.back().last;
 
-				if (N < diff_t(2)) return;
+				//分けたマージの片側は空のことがある
+				if (first == middle || middle == last) {
+					m_tasks.pop_back();
+					return 0;
+				}
 
-				//h最大を探索
-				diff_t h_max{};
-				for (diff_t ht = 1; ht < diff_t(N / 9); ht = (3 * ht + 1)) {
-					h_max = ht;
+				//既に正しい位置にある両端の要素は除く
+				first = std::size_t(std::upper_bound(m_begin + first, m_begin + middle, m_begin[middle], m_comp) - m_begin);
+				if (first == middle) {
+					m_tasks.pop_back();
+					return 0;
 				}
-				
-				for (auto h = h_max; diff_t(1) <= h; h = calc_h(h)) {
+				last = std::size_t(std::lower_bound(m_begin + middle, m_begin + last, m_begin[middle - 1], m_comp) - m_begin);
 
-					//注目要素
-					auto current = std::next(begin, h);
+				const auto left = middle - first;
+				const auto right = last - middle;
 
-					//先頭と次をとりあえず比較し入れ替え
-					detail::compare_and_swap(current, begin, comp);
+				if (std::min(m_buffer.capacity(), m_buffer_limit) < std::min(left, right)) {
+					//長い側の中央で分けて、[cut_left, middle)と[middle, cut_right)を回転すれば、前後の2つのマージになる
+					std::size_t cut_left, cut_right;
+					if (right <= left) {
+						cut_left = first + left / 2;
+						cut_right = std::size_t(std::lower_bound(m_begin + middle, m_begin + last, m_begin[cut_left], m_comp) - m_begin);
+					}
+					else {
+						cut_right = middle + right / 2;
+						cut_left = std::size_t(std::upper_bound(m_begin + first, m_begin + middle, m_begin[cut_right], m_comp) - m_begin);
+					}
+					const auto new_middle = cut_left + (cut_right - middle);
+
+					//ここで失敗しても状態は変わらない
+					m_tasks.reserve(m_tasks.size() + 2);
+					m_tasks.back() = task{ false, new_middle, cut_right, last, 0 };
+					m_tasks.push_back(task{ false, first, cut_left, new_middle, 0 });
+					m_tasks.push_back(task{ true, cut_left, middle, cut_right, 0 });
+					return 0;
+				}
 
-					//一つ前の要素
-					auto prev = begin;
+				//短い側を退避する
+				value_t* const buffer = m_buffer.data();
+				if (left <= right) {
+					value_t* const buffer_end = std::uninitialized_move(m_begin + first, m_begin + middle, buffer);
+					m_merge = active_merge{ true, first, last, first, middle, buffer, buffer_end };
+					m_merging = true;
+					return left + merge_forward(budget);
+				}
+				else {
+					value_t* const buffer_end = std::uninitialized_move(m_begin + middle, m_begin + last, buffer);
+					m_merge = active_merge{ false, first, last, last, middle, buffer_end, buffer_end };
+					m_merging = true;
+					return right + merge_backward(budget);
+				}
+			}
 
-					//挿入ソート
-					for (auto index = h + h; index < N; index += h) {
+			/**
+			* @brief 退避した左側と右側を先頭からマージする
+			* @detail 退避の量に関わらず、少なくとも1要素は進める
+			* @return 書き込んだ要素数
+			*/
+			auto merge_forward(std::size_t budget) -> std::size_t {
+				value_t* left_head = m_merge.buffer_head;
+				value_t* const buffer_end = m_merge.buffer_end;
+				auto right_head = m_merge.head;
+				auto out = m_merge.out;
+				const auto last = m_merge.last;
 
-						//要素を進める
-						prev = current;
-						std::advance(current, h);
+				//例外で抜けた場合も、進んだ位置をsuspend()へ伝える
+				struct position_guard {
+					active_merge& merge;
+					value_t*& left_head;
+					std::size_t& right_head;
+					std::size_t& out;
 
-						//正順でなければ挿入操作
-						if (comp(*prev, *current) == false) {
-							//currentの要素をコピー
-							auto tmp = std::move(*current);
+					~position_guard() {
+						merge.buffer_head = left_head;
+						merge.head = right_head;
+						merge.out = out;
+					}
+				} guard{ m_merge, left_head, right_head, out };
 
-							//前方に戻る前のprev
-							auto before_prev = current;
-							//挿入位置を探す
-							do {
-								*before_prev = std::move(*prev);
-								before_prev = prev;
-								//prevの方が先にbeginを飛び出すのでその対策
-								if (prev == begin) break;
-								std::advance(prev, -h);
-								//before_prevが先頭でなく、tmp < prevである間ループ
-							} while (comp(tmp, *prev));
-							//挿入
-							*before_prev = std::move(tmp);
-						}
+				std::size_t merged = 0;
+				while (left_head != buffer_end && right_head != last && merged < budget) {
+					//右側が小さい時だけ右側を取る（同値は左側が先）
+					if (m_comp(m_begin[right_head], *left_head)) {
+						m_begin[out] = std::move(m_begin[right_head]);
+						++right_head;
+					}
+					else {
+						m_begin[out] = std::move(*left_head);
+						++left_head;
 					}
+					++out;
+					++merged;
 				}
-			}
 
-			template<typename BidirectionalIterator, typename Compare>
-			constexpr void operator()(BidirectionalIterator begin, BidirectionalIterator end, Compare&& comp = detail::comp_v<BidirectionalIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
+				if (left_head == buffer_end || right_head == last) {
+					//右側が先に尽きたら左側の残りを移す。左側が先に尽きたら右側の残りは既に正しい位置にある
+					merged += std::size_t(buffer_end - left_head);
+					std::move(left_head, buffer_end, m_begin + out);
+					out += std::size_t(buffer_end - left_head);
+					left_head = buffer_end;
+					complete();
+				}
+				return merged;
 			}
-		};
 
-		/**
-		* @brief マージソート
-		*/
-		struct marge_sort {
-			static constexpr bool stable = false;
+			/**
+			* @brief 退避した右側と左側を末尾から逆向きにマージする
+			* @detail merge_forward()の向きを逆にしたもの
+			* @return 書き込んだ要素数
+			*/
+			auto merge_backward(std::size_t budget) -> std::size_t {
+				value_t* const buffer = m_buffer.data();
+				value_t* right_tail = m_merge.buffer_head;
+				auto left_tail = m_merge.head;
+				auto out = m_merge.out;
+				const auto first = m_merge.first;
 
-			using method = detail::category::method::insert;
+				struct position_guard {
+					active_merge& merge;
+					value_t*& right_tail;
+					std::size_t& left_tail;
+					std::size_t& out;
 
-			template<typename ForwardIterator, typename Compare>
-			static constexpr void sort(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) {
-				//イテレータ間距離の型
-				using diff_t  = typename std::iterator_traits<ForwardIterator>::difference_type;
-				using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+					~position_guard() {
+						merge.buffer_head = right_tail;
+						merge.head = left_tail;
+						merge.out = out;
+					}
+				} guard{ m_merge, right_tail, left_tail, out };
 
-				//要素数
-				auto N = diff_t(std::distance(begin, end));
+				std::size_t merged = 0;
+				while (right_tail != buffer && left_tail != first && merged < budget) {
+					//左側が大きい時だけ左側を取る（同値は右側が後）
+					if (m_comp(*(right_tail - 1), m_begin[left_tail - 1])) {
+						--left_tail;
+						--out;
+						m_begin[out] = std::move(m_begin[left_tail]);
+					}
+					else {
+						--right_tail;
+						--out;
+						m_begin[out] = std::move(*right_tail);
+					}
+					++merged;
+				}
 
-				//作業用メモリ確保
-				auto workspace = std::make_unique<value_t[]>(size_t(N));
-				
-				//委託
-				margesort_impl(begin, end, std::forward<Compare>(comp), workspace.get());
+				if (right_tail == buffer || left_tail == first) {
+					merged += std::size_t(right_tail - buffer);
+					std::move_backward(buffer, right_tail, m_begin + out);
+					out -= std::size_t(right_tail - buffer);
+					right_tail = buffer;
+					complete();
+				}
+				return merged;
 			}
 
-			template<typename ForwardIterator, typename Compare>
-			constexpr void operator()(ForwardIterator begin, ForwardIterator end, Compare&& comp = detail::comp_v<ForwardIterator>) const {
-				sort(begin, end, std::forward<Compare>(comp));
+			/**
+			* @brief 作業領域を使っているマージを終える
+			*/
+			void complete() noexcept {
+				std::destroy(m_buffer.data(), m_merge.buffer_end);
+				m_merging = false;
+				m_tasks.pop_back();
 			}
 
-		private:
-
-			template<typename ForwardIterator, typename Compare, typename T>
-			static constexpr void margesort_impl(ForwardIterator begin, ForwardIterator end, Compare&& comp, T* workspace) {
-				//イテレータ間距離の型
-				using diff_t = typename std::iterator_traits<ForwardIterator>::difference_type;
+			/**
+			* @brief 作業領域を使っているマージを中断し、退避している残りを範囲へ書き戻す
+			* @detail 書き戻した残りは、末尾のタスクの新しいマージになる
+			*/
+			void suspend() {
+				if (m_merging == false) return;
+				m_merging = false;
 
-				//要素数
-				auto N = diff_t(std::distance(begin, end));
+				value_t* const buffer = m_buffer.data();
+				std::size_t rest;
+				if (m_merge.forward) {
+					rest = std::size_t(m_merge.buffer_end - m_merge.buffer_head);
+					std::move(m_merge.buffer_head, m_merge.buffer_end, m_begin + m_merge.out);
+					m_tasks.back() = task{ false, m_merge.out, m_merge.head, m_merge.last, 0 };
+				}
+				else {
+					rest = std::size_t(m_merge.buffer_head - buffer);
+					std::move_backward(buffer, m_merge.buffer_head, m_begin + m_merge.out);
+					m_tasks.back() = task{ false, m_merge.first, m_merge.head, m_merge.out, 0 };
+				}
+				std::destroy(buffer, m_merge.buffer_end);
 
-				if (diff_t(2) < N) {
-					auto center_index = static_cast<diff_t>(std::ceil(N / 2.0));
-					auto center = std::next(begin, center_index);
+				//書き戻しと、再開時の退避
+				m_stats.operations += rest;
+				m_stats.overhead_operations += 2 * rest;
+			}
 
-					//右側シーケンスをソート
-					margesort_impl(begin, center, comp, workspace);
-					//左側シーケンスをソート
-					margesort_impl(center, end, comp, workspace);
+			/**
+			* @brief 末尾の回転を進める（Gries-Millsのブロック交換）
+			* @detail 交換だけで行うので、途中で止めても範囲には全ての要素が並んでいる
+			* @return 行った交換の数
+			*/
+			auto rotate(std::size_t budget) -> std::size_t {
+				auto& t = m_tasks.back();
+				std::size_t count = 0;
 
-					//左側の先頭
-					auto left_head = begin;
-					//右側の先頭
-					auto right_head = center;
+				while (t.first != t.middle && t.middle != t.last && count < budget) {
+					const auto left = t.middle - t.first;
+					const auto right = t.last - t.middle;
 
-					for (int i = 0; i < N; ++i) {
-						//*left_head < *right_head
-						if (comp(*left_head, *right_head) == true) {
-							workspace[i] = std::move(*left_head);
-							++left_head;
-							//左側シーケンスが先に移動し終わった場合はそのまま終わる（残りの右側はソート済み、かつコピーの必要がない）
-							if (left_head == center)break;
-						}
-						else {
-							workspace[i] = std::move(*right_head);
-							++right_head;
-							if (right_head == end) {
-								//左側シーケンスの残りを移動(forward iterator 要求とするためにあえて)
-								for (; left_head != center; ++left_head) {
-									++i;
-									workspace[i] = std::move(*left_head);
-								}
-							}
-						}
+					//短い側と、長い側の遠い端の同じ長さの部分を交換すると、その部分は最終位置に着く
+					const auto length = std::min(left, right);
+					const auto other = (left <= right) ? t.last - left : t.middle;
+					for (; t.progress < length && count < budget; ++t.progress, ++count) {
+						detail::iter_swap(m_begin + (t.first + t.progress), m_begin + (other + t.progress));
 					}
+					if (t.progress < length) break;
 
-					//元のシーケンスへコピー
-					int index = 0;
-					for (auto current = begin; current != right_head; ++current) {
-						*current = std::move(workspace[index]);
-						++index;
+					t.progress = 0;
+					if (left <= right) {
+						t.last -= left;
+					}
+					else {
+						t.first += right;
 					}
 				}
-				else if (N == diff_t(2)) {
-					detail::compare_and_swap(begin + 1, begin, comp);
-				}
-				else {
-					return;
-				}
+
+				m_stats.overhead_operations += count;
+				if (t.first == t.middle || t.middle == t.last) m_tasks.pop_back();
+				return count;
 			}
 
+			RandomAccessIterator m_begin;
+			std::size_t m_size;
+			Compare m_comp;
+			std::size_t m_max_buffer;
+			workspace<value_t, Allocator> m_buffer;
+			std::vector<task> m_tasks{};
+			active_merge m_merge{};
+			bool m_merging = false;
+			//このスライスで始めるマージが退避してよい要素数
+			std::size_t m_buffer_limit = 0;
+			//マージしているランの長さ（0ならランの作成中）
+			std::size_t m_width = 0;
+			//次に作るランか、次にマージする組の先頭
+			std::size_t m_position = 0;
+			bool m_done;
+			incremental_sort_stats m_stats{};
 		};
 	}
 
 	/**
 	* @brief コンテナに対しソートを行う
+	* @detail アルゴリズムがコンテナを受け取るsort()を持つ場合（std::list、std::forward_listに対するマージソート等）はそちらを使う
 	* @tparam SortAlgorithm ソートに使用するアルゴリズム
 	* @param container ソートしたい任意のコンテナ（::iterator = BidirectionalIteratorであること）
 	* @param comp 比較に使うファンクタ
 	*/
-	template<typename SortAlgorithm, typename Container, typename Compare>
+	template<typename SortAlgorithm, typename Container, typename Compare, std::enable_if_t<!detail::is_execution_policy_v<Container>, std::nullptr_t> = nullptr>
 	constexpr void sort(Container& container, Compare&& comp) {
 		using std::begin;
 		using std::end;
 
-		auto begin_it = begin(container);
-		auto end_it = end(container);
+		if constexpr (detail::has_container_sort_v<SortAlgorithm, Container, Compare>) {
+			//ノードの繋ぎ替えなど、コンテナ専用の実装
+			SortAlgorithm::sort(container, std::forward<Compare>(comp));
+		}
+		else {
+			auto begin_it = begin(container);
+			auto end_it = end(container);
 
-		SortAlgorithm::sort(begin_it, end_it, std::forward<Compare>(comp));
+			SortAlgorithm::sort(begin_it, end_it, std::forward<Compare>(comp));
+		}
 	}
 
 	/**
@@ -527,4 +6547,91 @@ namespace sort_collection {
 		SortAlgorithm::sort(begin, end, std::forward<Compare>(comp));
 	}
 
+	/**
+	* @brief 実行ポリシーを指定して範囲に対しソートを行う
+	* @detail 実行ポリシーを受け取るsort()を持たないアルゴリズムでは、逐次実行する
+	* @tparam SortAlgorithm ソートに使用するアルゴリズム
+	* @param policy 実行ポリシー（std::execution::seq, par, par_unseq）
+	* @param begin 範囲の初め
+	* @param end 範囲の終わり
+	* @param comp 比較に使うファンクタ
+	*/
+	template<typename SortAlgorithm, typename ExecutionPolicy, typename Iterator, typename Compare = detail::default_compare<Iterator>, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy>, std::nullptr_t> = nullptr>
+	void sort(ExecutionPolicy&& policy, Iterator begin, Iterator end, Compare&& comp = Compare{}) {
+		if constexpr (detail::has_execution_policy_sort_v<SortAlgorithm, ExecutionPolicy, Iterator, Compare>) {
+			SortAlgorithm::sort(std::forward<ExecutionPolicy>(policy), begin, end, std::forward<Compare>(comp));
+		}
+		else {
+			SortAlgorithm::sort(begin, end, std::forward<Compare>(comp));
+		}
+	}
+
+	/**
+	* @brief 実行ポリシーを指定してコンテナに対しソートを行う
+	* @tparam SortAlgorithm ソートに使用するアルゴリズム
+	* @param policy 実行ポリシー（std::execution::seq, par, par_unseq）
+	* @param container ソートしたい任意のコンテナ
+	* @param comp 比較に使うファンクタ
+	*/
+	template<typename SortAlgorithm, typename ExecutionPolicy, typename Container, typename Compare, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy> && detail::is_range_v<Container>, std::nullptr_t> = nullptr>
+	void sort(ExecutionPolicy&& policy, Container& container, Compare&& comp) {
+		using std::begin;
+		using std::end;
+
+		sort<SortAlgorithm>(std::forward<ExecutionPolicy>(policy), begin(container), end(container), std::forward<Compare>(comp));
+	}
+
+	/**
+	* @brief 実行ポリシーを指定してコンテナに対しソートを行う
+	* @tparam SortAlgorithm ソートに使用するアルゴリズム
+	* @param policy 実行ポリシー（std::execution::seq, par, par_unseq）
+	* @param container ソートしたい任意のコンテナ
+	*/
+	template<typename SortAlgorithm, typename ExecutionPolicy, typename Container, std::enable_if_t<detail::is_execution_policy_v<ExecutionPolicy> && detail::is_range_v<Container>, std::nullptr_t> = nullptr>
+	void sort(ExecutionPolicy&& policy, Container& container) {
+		using std::begin;
+		using iterator = std::remove_reference_t<decltype(begin(container))>;
+
+		sort<SortAlgorithm>(std::forward<ExecutionPolicy>(policy), container, detail::comp_v<iterator>);
+	}
+
+	namespace instrumentation {
+
+		/**
+		* @brief アルゴリズムが範囲をソートする間の操作回数を計測する
+		* @detail 要素をcounted<T>へ移してソートし、結果を元の範囲へ戻す。移し替えの操作は計測に含まない
+		* @detail 比較を行わない分布数え上げソートには、比較ファンクタをそのまま渡し要素の中身をキーとして射影させる
+		* @tparam SortAlgorithm 計測するアルゴリズム
+		* @param begin 範囲の初め
+		* @param end 範囲の終わり
+		* @param comp 比較に使うファンクタ
+		* @return 計測結果
+		*/
+		template<typename SortAlgorithm, typename ForwardIterator, typename Compare = sort_collection::detail::default_compare<ForwardIterator>>
+		auto count_operations(ForwardIterator begin, ForwardIterator end, Compare comp = Compare{}) -> operation_counts {
+			using value_t = typename std::iterator_traits<ForwardIterator>::value_type;
+
+			std::vector<counted<value_t>> elements;
+			elements.reserve(std::size_t(std::distance(begin, end)));
+			for (auto it = begin; it != end; ++it) elements.emplace_back(std::in_place, std::move(*it));
+
+			operation_counts result{};
+			{
+				scope measuring{};
+
+				if constexpr (std::is_same_v<typename SortAlgorithm::method, sort_collection::detail::category::method::distribution>) {
+					SortAlgorithm::sort(std::begin(elements), std::end(elements), comp, [](const counted<value_t>& element) -> const value_t& { return element.value; });
+				}
+				else {
+					SortAlgorithm::sort(std::begin(elements), std::end(elements), counted_compare<Compare>{ comp });
+				}
+
+				result = measuring.counts();
+			}
+
+			for (auto& element : elements) *begin++ = std::move(element.value);
+
+			return result;
+		}
+	}
 }
\ No newline at end of file
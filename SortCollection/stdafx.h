@@ -18,4 +18,11 @@
 #include <vector>
 #include <algorithm>
 #include <numeric>
-#include <random>
\ No newline at end of file
+#include <random>
+#include <memory_resource>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <forward_list>
+#include <string>
\ No newline at end of file
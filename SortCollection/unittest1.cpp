@@ -4,6 +4,8 @@
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 #include "sort.hpp"
+#include "external_sort.hpp"
+#include "zip_iterator.hpp"
 
 namespace SortCollection
 {
@@ -49,6 +51,14 @@ namespace SortCollection
 		Assert::IsTrue(std::equal(begin_it, end_it, expected, expected + size));
 	}
 
+	/**
+	* @brief 0からsizeof...(I) - 1までの要素数をstd::integral_constantで渡してfを呼ぶ
+	*/
+	template<typename F, std::size_t... I>
+	void for_each_size(F&& f, std::index_sequence<I...>) {
+		(f(std::integral_constant<std::size_t, I>{}), ...);
+	}
+
 	TEST_CLASS(UnitTest1)
 	{
 	public:
@@ -62,6 +72,39 @@ namespace SortCollection
 			Assert::IsFalse(std::equal(std::begin(array), std::end(array), expedted, expedted + 100));
 		}
 		
+		TEST_METHOD(compare_and_swap_test)
+		{
+			using sort_collection::detail::compare_and_swap;
+
+			//分岐しない実装でも、戻り値と交換結果は分岐する実装と同じ
+			auto check = [](auto lhs, auto rhs, auto comp) {
+				auto l = lhs, r = rhs;
+				const bool swapped = compare_and_swap(&l, &r, comp);
+				Assert::IsTrue(swapped == comp(lhs, rhs));
+				Assert::IsTrue(swapped ? (l == rhs && r == lhs) : (l == lhs && r == rhs));
+			};
+
+			for (auto [lhs, rhs] : { std::pair{ 1, 2 }, std::pair{ 2, 1 }, std::pair{ 3, 3 } }) {
+				check(lhs, rhs, std::less<>{});
+				check(lhs, rhs, std::greater<>{});
+				check(double(lhs), double(rhs), std::less<>{});
+				check(double(lhs), double(rhs), std::greater<double>{});
+				check(float(lhs), float(rhs), std::less<float>{});
+				check(float(lhs), float(rhs), std::greater<>{});
+			}
+
+			//同値の-0.0と+0.0は入れ替わらない
+			double zero = 0.0, negative_zero = -0.0;
+			Assert::IsFalse(compare_and_swap(&zero, &negative_zero, std::less<>{}));
+			Assert::IsFalse(std::signbit(zero));
+			Assert::IsTrue(std::signbit(negative_zero));
+
+			std::vector<double> reals(500);
+			for (std::size_t i = 0; i < reals.size(); ++i) reals[i] = double((i * 7919) % 500) - 250.5;
+			sort_collection::sort<sort_collection::comb_sort>(reals, std::greater<>{});
+			Assert::IsTrue(std::is_sorted(std::begin(reals), std::end(reals), std::greater<>{}));
+		}
+
 		TEST_METHOD(bubble_sort_test)
 		{
 			auto array = create_shuffled_vector(1000);
@@ -91,6 +134,16 @@ namespace SortCollection
 			sort_collection::sort<sort_collection::comb_sort>(array);
 
 			check_array<1000>(array);
+
+			//間隔の列が短くなる小さい範囲
+			for (int size = 0; size <= 32; ++size) {
+				std::vector<int> small(size);
+				std::iota(std::rbegin(small), std::rend(small), 1);
+
+				sort_collection::sort<sort_collection::comb_sort>(small);
+
+				Assert::IsTrue(std::is_sorted(std::begin(small), std::end(small)));
+			}
 		}
 
 		TEST_METHOD(gnome_sort_test)
@@ -115,7 +168,7 @@ namespace SortCollection
 		{
 			auto array = create_shuffled_vector(1000);
 
-			sort_collection::sort<sort_collection::selection_sort>(array);
+			sort_collection::sort<sort_collection::insertion_sort>(array);
 
 			check_array<1000>(array);
 		}
@@ -127,6 +180,116 @@ namespace SortCollection
 			sort_collection::sort<sort_collection::shell_sort>(array);
 
 			check_array<1000>(array);
+
+			//間隔の列が短くなる小さい範囲
+			for (int size = 0; size <= 32; ++size) {
+				std::vector<int> small(size);
+				std::iota(std::rbegin(small), std::rend(small), 1);
+
+				sort_collection::sort<sort_collection::shell_sort>(small);
+
+				Assert::IsTrue(std::is_sorted(std::begin(small), std::end(small)));
+			}
+		}
+
+		TEST_METHOD(gap_sequence_test)
+		{
+			namespace gap = sort_collection::gap_sequence;
+
+			//表はコンパイル時に作られ、1から始まる
+			static_assert(gap::knuth::gaps[3] == 40);
+			static_assert(gap::ciura::gaps[8] == 1750 && gap::ciura::gaps[9] == 3937);
+			static_assert(gap::tokuda::gaps[5] == 103);
+			static_assert(gap::sedgewick::gaps[4] == 281);
+			static_assert(gap::pratt::gaps[7] == 12);
+			static_assert(gap::comb11::gaps[6] == 11);
+
+			auto check = [](auto sort) {
+				for (int size : { 0, 1, 2, 31, 1000, 20000 }) {
+					auto array = create_shuffled_vector(size);
+					sort(std::begin(array), std::end(array), std::less<>{});
+					Assert::IsTrue(std::is_sorted(std::begin(array), std::end(array)));
+				}
+			};
+
+			check(sort_collection::basic_shell_sort<gap::knuth>{});
+			check(sort_collection::basic_shell_sort<gap::ciura>{});
+			check(sort_collection::basic_shell_sort<gap::tokuda>{});
+			check(sort_collection::basic_shell_sort<gap::sedgewick>{});
+			check(sort_collection::basic_shell_sort<gap::pratt>{});
+			check(sort_collection::basic_comb_sort<gap::comb11>{});
+		}
+
+		TEST_METHOD(network_sort_test)
+		{
+			//比較器の数（N <= 8は最適）
+			static_assert(sort_collection::network_sort<4>::network.size() == 5);
+			static_assert(sort_collection::network_sort<8>::network.size() == 19);
+			static_assert(sort_collection::network_sort<16>::network.size() == 63);
+
+			//0と1だけの並び（0-1原理）をソートできる。16要素までは全ての並びを試す
+			auto check = [](auto size) {
+				constexpr std::size_t N = decltype(size)::value;
+				for (std::uint32_t bits = 0; bits < (std::uint32_t(1) << std::min<std::size_t>(N, 16)); ++bits) {
+					std::array<int, N> array{};
+					for (std::size_t i = 0; i < N; ++i) array[i] = int((bits >> (i % 16)) & 1);
+
+					sort_collection::sort<sort_collection::network_sort<N>>(array);
+
+					Assert::IsTrue(std::is_sorted(std::begin(array), std::end(array)));
+				}
+			};
+			for_each_size(check, std::make_index_sequence<33>{});
+
+			//C配列、降順、要素数が違う範囲（挿入ソートになる）
+			double values[32]{};
+			for (int i = 0; i < 32; ++i) values[i] = double((i * 7) % 32);
+			sort_collection::sort<sort_collection::network_sort<32>>(values, std::greater<>{});
+			Assert::IsTrue(std::is_sorted(std::begin(values), std::end(values), std::greater<>{}));
+
+			auto array = create_shuffled_vector(100);
+			sort_collection::sort<sort_collection::network_sort<32>>(array);
+			check_array<100>(array);
+		}
+
+		TEST_METHOD(constexpr_sort_test)
+		{
+			//定数式の中でソートして表を作れる
+			constexpr auto sorted = [](auto algorithm) {
+				std::array<int, 200> array{};
+				for (int i = 0; i < 200; ++i) array[i] = (i * 67 + 13) % 200;
+				decltype(algorithm)::sort(std::begin(array), std::end(array), std::less<>{});
+				return array;
+			};
+
+			static_assert(sorted(sort_collection::bubble_sort{})[0] == 0);
+			static_assert(sorted(sort_collection::comb_sort{})[199] == 199);
+			static_assert(sorted(sort_collection::selection_sort{})[100] == 100);
+			static_assert(sorted(sort_collection::insertion_sort{})[100] == 100);
+			static_assert(sorted(sort_collection::shell_sort{})[100] == 100);
+			static_assert(sorted(sort_collection::stable_auto_sort{})[100] == 100);
+#if !defined(SORT_COLLECTION_INSTRUMENTATION)
+			//計測を有効にすると、再帰の深さを記録するpdqソート（とそれを使うアルゴリズム）は定数評価できない
+			static_assert(sorted(sort_collection::pdq_sort{})[100] == 100);
+			static_assert(sorted(sort_collection::auto_sort{})[100] == 100);
+			static_assert(sorted(sort_collection::three_way_quick_sort{})[100] == 100);
+
+			constexpr auto selected = [] {
+				std::array<int, 200> array{};
+				for (int i = 0; i < 200; ++i) array[i] = (i * 67 + 13) % 200;
+				sort_collection::partial_sort::sort(std::begin(array), std::begin(array) + 10, std::end(array));
+				return array;
+			}();
+			static_assert(selected[0] == 0 && selected[9] == 9);
+#endif
+
+			constexpr auto table = [] {
+				std::array<double, 16> array{};
+				for (int i = 0; i < 16; ++i) array[i] = double((i * 5) % 16) / 2;
+				sort_collection::sort<sort_collection::network_sort<16>>(array, std::greater<>{});
+				return array;
+			}();
+			static_assert(table[0] == 7.5 && table[15] == 0.0);
 		}
 
 		TEST_METHOD(marge_sort_test)
@@ -137,5 +300,862 @@ namespace SortCollection
 
 			check_array<1000>(array);
 		}
+
+		TEST_METHOD(marge_sort_workspace_test)
+		{
+			sort_collection::workspace<int> workspace{};
+
+			for (int i = 0; i < 3; ++i) {
+				auto array = create_shuffled_vector(1000);
+
+				sort_collection::marge_sort::sort(std::begin(array), std::end(array), std::less<>{}, workspace);
+
+				check_array<1000>(array);
+			}
+
+			//逐次版は半分の作業領域で足り、使い回している間は拡張されない
+			Assert::IsTrue(workspace.capacity() == sort_collection::marge_sort::workspace_size(1000));
+
+			//メモリリソースとアロケータ
+			std::pmr::monotonic_buffer_resource resource{};
+			auto array = create_shuffled_vector(1000);
+			sort_collection::marge_sort::sort(std::begin(array), std::end(array), std::less<>{}, &resource);
+			check_array<1000>(array);
+
+			array = create_shuffled_vector(1000);
+			sort_collection::marge_sort::sort(std::begin(array), std::end(array), std::less<>{}, std::allocator_arg, std::allocator<char>{});
+			check_array<1000>(array);
+		}
+
+		TEST_METHOD(marge_sort_non_default_constructible_test)
+		{
+			struct element {
+				explicit element(int v) : value(v) {}
+				int value;
+			};
+
+			auto source = create_shuffled_vector(1000);
+			std::vector<element> array;
+			for (auto n : source) array.emplace_back(n);
+
+			sort_collection::sort<sort_collection::marge_sort>(array, [](const element& lhs, const element& rhs) { return lhs.value < rhs.value; });
+
+			std::vector<int> result;
+			for (auto& e : array) result.push_back(e.value);
+			check_array<1000>(result);
+		}
+
+		TEST_METHOD(block_merge_sort_test)
+		{
+			auto array = create_shuffled_vector(10000);
+			sort_collection::sort<sort_collection::block_merge_sort>(array, std::less<>{});
+			check_array<10000>(array);
+
+			//値の種類が多ければ内部バッファ、少なければ目印だけでマージする。どちらも安定
+			auto by_key = [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) { return lhs.first < rhs.first; };
+			for (int kinds : { 2, 3, 50, 1000, 1 << 30 }) {
+				for (std::size_t capacity : { 0, 100 }) {
+					std::vector<std::pair<int, int>> pairs(5000);
+					for (std::size_t i = 0; i < pairs.size(); ++i) pairs[i] = { int(i * 7919 % 100003 % kinds), int(i) };
+
+					sort_collection::workspace<std::pair<int, int>> workspace{ capacity };
+					sort_collection::block_merge_sort::sort(std::begin(pairs), std::end(pairs), by_key, workspace);
+
+					Assert::IsTrue(std::is_sorted(std::begin(pairs), std::end(pairs)));
+					//作業領域は拡張しない
+					Assert::AreEqual(capacity, workspace.capacity());
+				}
+			}
+		}
+
+		TEST_METHOD(incremental_sort_test)
+		{
+			auto array = create_shuffled_vector(10000);
+			sort_collection::incremental_sort sorter(std::begin(array), std::end(array));
+			while (sorter.step(1000) == false) {}
+			check_array<10000>(array);
+			Assert::IsTrue(sorter.stats().slices > 1);
+
+			//どのスライスの後でも全ての要素が1つずつ並んでいて、最後は安定にソートされる
+			auto by_key = [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) { return lhs.first < rhs.first; };
+			for (std::size_t max_buffer : { 1, 64, 100000 }) {
+				std::vector<std::pair<int, int>> pairs(3000);
+				for (std::size_t i = 0; i < pairs.size(); ++i) pairs[i] = { int(i * 7919 % 100003 % 500), int(i) };
+				auto expected = pairs;
+				std::sort(std::begin(expected), std::end(expected));
+
+				sort_collection::incremental_sort partial(std::begin(pairs), std::end(pairs), by_key, max_buffer);
+				while (partial.step(37) == false) {
+					auto snapshot = pairs;
+					std::sort(std::begin(snapshot), std::end(snapshot));
+					Assert::IsTrue(snapshot == expected);
+				}
+				Assert::IsTrue(pairs == expected);
+
+				//作業領域に収まらないマージの回転と、中断時の書き戻しが余分な仕事として数えられる
+				const auto& stats = partial.stats();
+				Assert::IsTrue(stats.overhead_operations < stats.operations);
+				Assert::IsTrue(0.0 < stats.overhead_ratio());
+			}
+
+			//期限で区切る
+			auto strings = std::vector<std::string>(20000);
+			for (std::size_t i = 0; i < strings.size(); ++i) strings[i] = std::to_string(i * 7919 % 20011);
+			sort_collection::incremental_sort by_time(std::begin(strings), std::end(strings));
+			while (by_time.step_for(std::chrono::microseconds(100)) == false) {}
+			Assert::IsTrue(std::is_sorted(std::begin(strings), std::end(strings)));
+
+			//一度に終わらせれば余分な仕事はない
+			auto once = create_shuffled_vector(10000);
+			sort_collection::incremental_sort at_once(std::begin(once), std::end(once));
+			at_once.finish();
+			check_array<10000>(once);
+			Assert::AreEqual(std::size_t(0), at_once.stats().overhead_operations);
+		}
+
+		TEST_METHOD(tim_sort_test)
+		{
+			auto array = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::tim_sort>(array);
+
+			check_array<1000>(array);
+
+			//整列済みの列を繋げた入力は、ランをそのまま使って比較回数がO(N)で済む
+			std::vector<int> batches(1000);
+			std::iota(std::begin(batches), std::begin(batches) + 500, 501);
+			std::iota(std::begin(batches) + 500, std::end(batches), 1);
+
+			auto counts = sort_collection::instrumentation::count_operations<sort_collection::tim_sort>(std::begin(batches), std::end(batches));
+			check_array<1000>(batches);
+			Assert::IsTrue(counts.comparisons < 1100);
+
+			//降順のランの反転とギャロッピングを含む安定ソート
+			std::vector<std::pair<int, int>> records;
+			for (int i = 0; i < 3000; ++i) records.emplace_back((i < 1500) ? 1500 - i : i % 7, i);
+			auto expected = records;
+			auto by_first = [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; };
+			std::stable_sort(std::begin(expected), std::end(expected), by_first);
+
+			sort_collection::tim_sort::sort(std::begin(records), std::end(records), by_first);
+			Assert::IsTrue(records == expected);
+		}
+
+		TEST_METHOD(pdq_sort_test)
+		{
+			auto array = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::pdq_sort>(array);
+
+			check_array<1000>(array);
+
+			//ブロック分割を使わない比較ファンクタ
+			array = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::pdq_sort>(array, [](int lhs, int rhs) { return lhs < rhs; });
+
+			check_array<1000>(array);
+
+			//整列済み・逆順・重複の多い入力
+			std::vector<int> patterns(100000);
+			std::iota(std::begin(patterns), std::end(patterns), 0);
+			sort_collection::sort<sort_collection::pdq_sort>(patterns);
+			Assert::IsTrue(std::is_sorted(std::begin(patterns), std::end(patterns)));
+
+			std::reverse(std::begin(patterns), std::end(patterns));
+			sort_collection::sort<sort_collection::pdq_sort>(patterns);
+			Assert::IsTrue(std::is_sorted(std::begin(patterns), std::end(patterns)));
+
+			for (auto& n : patterns) n %= 7;
+			sort_collection::sort<sort_collection::pdq_sort>(patterns, std::greater<>{});
+			Assert::IsTrue(std::is_sorted(std::begin(patterns), std::end(patterns), std::greater<>{}));
+		}
+
+		TEST_METHOD(selection_test)
+		{
+			auto array = create_shuffled_vector(1000);
+
+			//nth_elementは指定位置に整列後と同じ値を置き、前後で分割する
+			sort_collection::nth_element::select(std::begin(array), std::begin(array) + 300, std::end(array));
+			Assert::AreEqual(301, array[300]);
+			Assert::IsTrue(std::all_of(std::begin(array), std::begin(array) + 300, [](int n) { return n <= 301; }));
+			Assert::IsTrue(std::all_of(std::begin(array) + 300, std::end(array), [](int n) { return 301 <= n; }));
+
+			//重複だらけの入力
+			std::vector<int> duplicates(10000);
+			for (std::size_t i = 0; i < duplicates.size(); ++i) duplicates[i] = int((i * 7919) % 3);
+			auto expected = duplicates;
+			std::sort(std::begin(expected), std::end(expected));
+			sort_collection::nth_element::select(std::begin(duplicates), std::begin(duplicates) + 5000, std::end(duplicates));
+			Assert::AreEqual(expected[5000], duplicates[5000]);
+
+			//partial_sortは先頭k個だけを整列する
+			array = create_shuffled_vector(1000);
+			sort_collection::partial_sort::sort(std::begin(array), std::begin(array) + 100, std::end(array));
+			Assert::IsTrue(std::equal(std::begin(array), std::begin(array) + 100, expected_array<100>()));
+
+			//top_kは入力を一度だけ読む
+			array = create_shuffled_vector(1000);
+			const auto top = sort_collection::top_k::select(std::begin(array), std::end(array), 10, std::greater<>{});
+			Assert::AreEqual(std::size_t(10), top.size());
+			for (int i = 0; i < 10; ++i) Assert::AreEqual(1000 - i, top[i]);
+
+			sort_collection::top_k_accumulator<int> accumulator{ 5 };
+			for (int n : array) accumulator.push(n);
+			Assert::AreEqual(5, accumulator.threshold());
+			Assert::IsTrue(std::equal(std::begin(expected_array<5>()), std::end(expected_array<5>()), std::begin(accumulator.take())));
+
+			//kが要素数より大きければ全要素を返す（kの分の領域は確保しない）
+			const std::vector<int> few = { 3, 1, 2 };
+			const auto all = sort_collection::top_k::select(std::begin(few), std::end(few), std::numeric_limits<std::size_t>::max() / 2);
+			Assert::IsTrue(all == std::vector<int>{ 1, 2, 3 });
+		}
+
+		TEST_METHOD(cached_key_sort_test)
+		{
+			//射影は要素ごとに1回だけ呼ばれる
+			auto array = create_shuffled_vector(1000);
+			std::size_t calls = 0;
+			const auto negate = [&calls](int n) { ++calls; return -n; };
+
+			sort_collection::cached_key_sort<sort_collection::shell_sort>::sort(std::begin(array), std::end(array), std::greater<>{}, negate);
+
+			check_array<1000>(array);
+			Assert::AreEqual(std::size_t(1000), calls);
+
+			//文字列のキーで安定にソートする
+			std::vector<std::pair<std::string, int>> records;
+			for (int i = 0; i < 300; ++i) records.emplace_back(std::to_string(i % 30), i);
+
+			sort_collection::cached_key_sort<sort_collection::tim_sort>::sort(std::begin(records), std::end(records), std::less<>{}, [](const auto& r) { return std::stoi(r.first); });
+			Assert::IsTrue(std::is_sorted(std::begin(records), std::end(records), [](const auto& lhs, const auto& rhs) { return std::stoi(lhs.first) < std::stoi(rhs.first) || (lhs.first == rhs.first && lhs.second < rhs.second); }));
+
+			//分布数え上げソートにはキーを射影として渡す
+			std::list<int> list(std::begin(expected_array<100>()), std::end(expected_array<100>()));
+			sort_collection::cached_key_sort<sort_collection::radix_sort>::sort(std::begin(list), std::end(list), std::less<>{}, [](int n) { return n % 10 * 100 + n / 10; });
+			Assert::AreEqual(10, list.front());
+			Assert::AreEqual(99, list.back());
+		}
+
+		TEST_METHOD(argsort_test)
+		{
+			//大きな要素は動かさず、添字だけを並べ替える
+			struct record {
+				int key;
+				char payload[196];
+			};
+
+			const auto keys = create_shuffled_vector(1000);
+			std::vector<record> records(keys.size());
+			std::vector<int> parallel(keys.size());
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				records[i].key = keys[i];
+				parallel[i] = -keys[i];
+			}
+
+			const auto permutation = sort_collection::argsort<sort_collection::marge_sort>(records, [](const record& lhs, const record& rhs) { return lhs.key < rhs.key; });
+			for (std::size_t i = 0; i < permutation.size(); ++i) Assert::AreEqual(int(i) + 1, keys[permutation[i]]);
+
+			//同じ順序を並列な配列それぞれへ適用する
+			sort_collection::apply_permutation(records, permutation);
+			sort_collection::apply_permutation(std::begin(parallel), std::end(parallel), permutation);
+			for (std::size_t i = 0; i < records.size(); ++i) {
+				Assert::AreEqual(int(i) + 1, records[i].key);
+				Assert::AreEqual(-(int(i) + 1), parallel[i]);
+			}
+
+			//安定なアルゴリズムでは同値の添字は元の順に並ぶ
+			std::vector<int> duplicates(200);
+			for (std::size_t i = 0; i < duplicates.size(); ++i) duplicates[i] = int(i % 4);
+			const auto stable_permutation = sort_collection::argsort<sort_collection::radix_sort>(std::begin(duplicates), std::end(duplicates));
+			Assert::IsTrue(std::is_sorted(std::begin(stable_permutation), std::end(stable_permutation), [&](std::size_t lhs, std::size_t rhs) { return duplicates[lhs] < duplicates[rhs] || (duplicates[lhs] == duplicates[rhs] && lhs < rhs); }));
+		}
+
+		TEST_METHOD(merge_insert_test)
+		{
+			//ソート済みの配列へ追加分をマージし続ける
+			std::vector<int> sorted;
+			sort_collection::workspace<int> buffer{};
+			std::vector<int> expected;
+
+			for (int batch_size : { 0, 1, 10, 1000, 3, 5000, 64 }) {
+				auto batch = create_shuffled_vector(batch_size);
+				for (auto& v : batch) v = v * 7 % 1009;
+
+				sort_collection::sorted_append<sort_collection::pdq_sort>(sorted, std::begin(batch), std::end(batch), std::less<int>{}, buffer);
+
+				expected.insert(std::end(expected), std::begin(batch), std::end(batch));
+				std::sort(std::begin(expected), std::end(expected));
+				Assert::IsTrue(sorted == expected);
+			}
+
+			//既存の最大要素以上の追加分は動かさず、作業領域も使わない
+			sort_collection::workspace<int> unused{};
+			std::vector<int> tail = { 1, 2, 3, 7, 6, 5 };
+			sort_collection::merge_insert<sort_collection::insertion_sort>(std::begin(tail), std::begin(tail) + 3, std::end(tail), std::less<int>{}, unused);
+			Assert::IsTrue(tail == std::vector<int>{ 1, 2, 3, 5, 6, 7 });
+			Assert::AreEqual(std::size_t(0), unused.capacity());
+
+			//同値の追加分は既存の要素の後ろに並ぶ（安定）。長い方の範囲は退避しない
+			std::vector<std::pair<int, int>> pairs;
+			for (int i = 0; i < 100; ++i) pairs.emplace_back(i % 10, 0);
+			std::sort(std::begin(pairs), std::end(pairs));
+			for (int i = 0; i < 30; ++i) pairs.emplace_back(9 - i % 10, 1 + i);
+			auto by_key = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+			sort_collection::workspace<std::pair<int, int>> pair_buffer{};
+			sort_collection::merge_insert<sort_collection::marge_sort>(std::begin(pairs), std::begin(pairs) + 100, std::end(pairs), by_key, pair_buffer);
+			Assert::IsTrue(std::is_sorted(std::begin(pairs), std::end(pairs)));
+			Assert::IsTrue(pair_buffer.capacity() <= 30);
+
+			//BidirectionalIteratorのコンテナ
+			std::list<int> list = { 1, 3, 5, 7, 9 };
+			const std::vector<int> additions = { 8, 0, 4, 10 };
+			sort_collection::sorted_append<sort_collection::insertion_sort>(list, std::begin(additions), std::end(additions));
+			Assert::IsTrue(list == std::list<int>{ 0, 1, 3, 4, 5, 7, 8, 9, 10 });
+		}
+
+		TEST_METHOD(multiway_merge_test)
+		{
+			//ソート済みの断片（空の断片を含む）を1本にマージする。同値は前の断片の要素が先に並ぶ
+			std::vector<std::vector<std::pair<int, int>>> shards(9);
+			std::mt19937 engine{ 23 };
+			for (std::size_t i = 0; i < shards.size(); ++i) {
+				if (i % 4 == 1) continue;
+				for (std::size_t j = 0; j < 100 * i + 1; ++j) shards[i].emplace_back(int(engine() % 50), int(i));
+				std::sort(std::begin(shards[i]), std::end(shards[i]));
+			}
+			auto by_key = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+
+			std::vector<std::pair<int, int>> merged;
+			sort_collection::multiway_merge(std::begin(shards), std::end(shards), std::back_inserter(merged), by_key);
+			auto expected = std::accumulate(std::begin(shards), std::end(shards), std::vector<std::pair<int, int>>{}, [](auto acc, const auto& shard) { acc.insert(std::end(acc), std::begin(shard), std::end(shard)); return acc; });
+			std::stable_sort(std::begin(expected), std::end(expected), by_key);
+			Assert::IsTrue(merged == expected);
+
+			//イテレータの組で渡した断片
+			const int a[] = { 1, 4, 7 }, b[] = { 2, 5, 8 }, c[] = { 0, 3, 6, 9 };
+			const std::vector<std::pair<const int*, const int*>> ranges = { { std::begin(a), std::end(a) }, { std::begin(b), std::end(b) }, { std::begin(c), std::end(c) } };
+			std::vector<int> digits(10);
+			Assert::IsTrue(sort_collection::multiway_merge(std::begin(ranges), std::end(ranges), std::begin(digits)) == std::end(digits));
+			Assert::IsTrue(std::is_sorted(std::begin(digits), std::end(digits)) && digits.front() == 0 && digits.back() == 9);
+
+			//並列版は出力を分割点で分けてマージする
+			std::vector<std::vector<std::pair<int, int>>> large(6);
+			for (std::size_t i = 0; i < large.size(); ++i) {
+				for (std::size_t j = 0; j < 40000; ++j) large[i].emplace_back(int(engine() % 1000), int(i));
+				std::sort(std::begin(large[i]), std::end(large[i]));
+			}
+			std::vector<std::pair<int, int>> serial, parallel(6 * 40000);
+			sort_collection::multiway_merge(std::begin(large), std::end(large), std::back_inserter(serial), by_key);
+			sort_collection::multiway_merge(std::execution::par, std::begin(large), std::end(large), std::begin(parallel), by_key);
+			Assert::IsTrue(parallel == serial);
+		}
+
+		TEST_METHOD(zip_iterator_test)
+		{
+			//列ごとに分かれたデータをキーの列でソートする
+			auto keys = create_shuffled_vector(1000);
+			std::vector<std::string> names(keys.size());
+			std::vector<double> weights(keys.size());
+			for (std::size_t i = 0; i < keys.size(); ++i) {
+				names[i] = std::to_string(keys[i]);
+				weights[i] = keys[i] * 0.5;
+			}
+
+			auto check_columns = [&]() {
+				check_array<1000>(keys);
+				for (std::size_t i = 0; i < keys.size(); ++i) {
+					Assert::AreEqual(std::to_string(keys[i]), names[i]);
+					Assert::AreEqual(keys[i] * 0.5, weights[i]);
+				}
+			};
+
+			auto columns = sort_collection::zip(keys, names, weights);
+
+			sort_collection::sort<sort_collection::pdq_sort>(columns, sort_collection::by_column<0>());
+			check_columns();
+
+			//挿入ソート系
+			std::shuffle(std::begin(columns), std::end(columns), std::mt19937{ 1 });
+			sort_collection::sort<sort_collection::shell_sort>(columns, sort_collection::by_column<0>());
+			check_columns();
+
+			std::shuffle(std::begin(columns), std::end(columns), std::mt19937{ 2 });
+			sort_collection::sort<sort_collection::insertion_sort>(columns, sort_collection::by_column<0>());
+			check_columns();
+
+			//作業領域は列の値のtupleで持つ
+			sort_collection::workspace<std::tuple<int, std::string, double>> workspace{};
+			std::shuffle(std::begin(columns), std::end(columns), std::mt19937{ 3 });
+			sort_collection::marge_sort::sort(std::begin(columns), std::end(columns), sort_collection::by_column<0>(), workspace);
+			check_columns();
+
+			//compare_and_swapは全ての列を入れ替える
+			Assert::IsTrue(sort_collection::detail::compare_and_swap(std::next(std::begin(columns)), std::begin(columns), sort_collection::by_column<0, std::greater<>>()));
+			Assert::AreEqual(2, keys[0]);
+			Assert::AreEqual(std::string("2"), names[0]);
+			Assert::AreEqual(1.0, weights[0]);
+		}
+
+		TEST_METHOD(linked_list_sort_test)
+		{
+			//ムーブもコピーもできない要素でも、ノードの繋ぎ替えならソートできる
+			struct pinned {
+				int key;
+				int order;
+
+				pinned(int k, int o) : key(k), order(o) {}
+				pinned(const pinned&) = delete;
+				pinned& operator=(const pinned&) = delete;
+			};
+			const auto by_key = [](const pinned& lhs, const pinned& rhs) { return lhs.key < rhs.key; };
+			const auto is_stably_sorted = [](const auto& list) {
+				return std::is_sorted(std::begin(list), std::end(list), [](const pinned& lhs, const pinned& rhs) { return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.order < rhs.order); });
+			};
+
+			const auto keys = create_shuffled_vector(1000);
+
+			std::list<pinned> list;
+			std::forward_list<pinned> forward_list;
+			for (int i = 0; i < 1000; ++i) list.emplace_back(keys[i] % 100, i);
+			for (int i = 999; 0 <= i; --i) forward_list.emplace_front(keys[i] % 100, i);
+
+			sort_collection::sort<sort_collection::marge_sort>(list, by_key);
+			sort_collection::sort<sort_collection::stable_auto_sort>(forward_list, by_key);
+
+			Assert::AreEqual(std::size_t(1000), list.size());
+			Assert::IsTrue(is_stably_sorted(list));
+			Assert::IsTrue(is_stably_sorted(forward_list));
+
+			//短いリストでもノードを繋ぎ替える
+			std::list<pinned> short_list;
+			for (int i = 0; i < 10; ++i) short_list.emplace_back(keys[i] % 3, i);
+			sort_collection::sort<sort_collection::auto_sort>(short_list, by_key);
+			Assert::IsTrue(is_stably_sorted(short_list));
+
+			//ForwardIteratorでも要素数に比例する走査で済むアルゴリズム
+			std::forward_list<int> numbers(std::begin(keys), std::end(keys));
+			sort_collection::sort<sort_collection::comb_sort>(numbers, std::less<>{});
+			Assert::IsTrue(std::is_sorted(std::begin(numbers), std::end(numbers)));
+
+			numbers.assign(std::begin(keys), std::end(keys));
+			sort_collection::sort<sort_collection::selection_sort>(numbers, std::less<>{});
+			Assert::IsTrue(std::is_sorted(std::begin(numbers), std::end(numbers)));
+		}
+
+		TEST_METHOD(radix_sort_test)
+		{
+			auto array = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::radix_sort>(array);
+
+			check_array<1000>(array);
+
+			//符号付き・浮動小数点数のキーと降順
+			std::vector<double> reals = { 3.5, -0.25, 1e10, -1e10, 0.0, 2.0, -7.0 };
+			sort_collection::sort<sort_collection::radix_sort>(reals, std::greater<>{});
+			Assert::IsTrue(std::is_sorted(std::begin(reals), std::end(reals), std::greater<>{}));
+
+			//-0.0と+0.0は等しいので、入力の順に並ぶ
+			std::vector<double> zeros;
+			std::mt19937 engine{ 7 };
+			for (int i = 0; i < 5000; ++i) zeros.push_back(engine() % 3 == 0 ? (engine() % 2 ? -0.0 : 0.0) : double(int(engine() % 100) - 50));
+			auto stable_zeros = zeros;
+			std::stable_sort(std::begin(stable_zeros), std::end(stable_zeros));
+			sort_collection::sort<sort_collection::radix_sort>(zeros);
+			Assert::IsTrue(std::equal(std::begin(zeros), std::end(zeros), std::begin(stable_zeros), [](double lhs, double rhs) { return lhs == rhs && std::signbit(lhs) == std::signbit(rhs); }));
+
+			//射影したキーで安定にソート
+			std::vector<std::pair<int, int>> records;
+			for (auto n : create_shuffled_vector(1000)) records.emplace_back(n % 10 - 5, n);
+			auto expected = records;
+			std::stable_sort(std::begin(expected), std::end(expected), [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; });
+
+			sort_collection::radix_sort::sort(std::begin(records), std::end(records), std::less<>{}, [](auto& record) { return record.first; });
+
+			Assert::IsTrue(records == expected);
+
+			//作業領域を確保できなくても安定
+			std::shuffle(std::begin(records), std::end(records), std::mt19937{ 4 });
+			expected = records;
+			std::stable_sort(std::begin(expected), std::end(expected), [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; });
+
+			sort_collection::pmr::workspace<std::pair<int, int>> no_memory{ std::pmr::polymorphic_allocator<std::pair<int, int>>{ std::pmr::null_memory_resource() } };
+			sort_collection::radix_sort::sort(std::begin(records), std::end(records), std::less<>{}, [](auto& record) { return record.first; }, no_memory);
+
+			Assert::IsTrue(records == expected);
+		}
+
+		TEST_METHOD(american_flag_sort_test)
+		{
+			auto array = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::american_flag_sort>(array);
+
+			check_array<1000>(array);
+		}
+
+		TEST_METHOD(counting_sort_test)
+		{
+			auto array = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::counting_sort>(array);
+
+			check_array<1000>(array);
+
+			//値の種類が少ない符号付き整数と降順
+			std::vector<int> codes;
+			for (auto n : create_shuffled_vector(1000)) codes.push_back(n % 5 - 2);
+			auto expected = codes;
+			std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+			sort_collection::sort<sort_collection::counting_sort>(codes, std::greater<>{});
+			Assert::IsTrue(codes == expected);
+
+			//射影したキーで安定にソート（値域が広ければ基数ソートになる）
+			for (int spread : { 10, 1 << 24 }) {
+				std::vector<std::pair<int, int>> records;
+				for (auto n : create_shuffled_vector(1000)) records.emplace_back(n % 10 * spread, n);
+				auto stable_expected = records;
+				std::stable_sort(std::begin(stable_expected), std::end(stable_expected), [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; });
+
+				sort_collection::counting_sort::sort(std::begin(records), std::end(records), std::less<>{}, [](auto& record) { return record.first; });
+				Assert::IsTrue(records == stable_expected);
+			}
+
+			//64ビットの値域全体に及ぶキー（値域の大きさが溢れる）は基数ソートになる
+			std::vector<std::uint64_t> full_unsigned = { 5, 0, std::numeric_limits<std::uint64_t>::max(), 3, 2, 1 };
+			sort_collection::sort<sort_collection::counting_sort>(full_unsigned);
+			Assert::IsTrue(full_unsigned == std::vector<std::uint64_t>{ 0, 1, 2, 3, 5, std::numeric_limits<std::uint64_t>::max() });
+
+			std::vector<std::pair<std::int64_t, int>> full_signed = { { 5, 0 }, { std::numeric_limits<std::int64_t>::min(), 1 }, { std::numeric_limits<std::int64_t>::max(), 2 }, { 5, 3 }, { -1, 4 } };
+			sort_collection::counting_sort::sort(std::begin(full_signed), std::end(full_signed), std::less<>{}, [](auto& record) { return record.first; });
+			Assert::IsTrue(full_signed == std::vector<std::pair<std::int64_t, int>>{ { std::numeric_limits<std::int64_t>::min(), 1 }, { -1, 4 }, { 5, 0 }, { 5, 3 }, { std::numeric_limits<std::int64_t>::max(), 2 } });
+		}
+
+		TEST_METHOD(three_way_quick_sort_test)
+		{
+			auto array = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::three_way_quick_sort>(array);
+
+			check_array<1000>(array);
+
+			//重複の多い文字列
+			std::vector<std::string> statuses;
+			for (auto n : create_shuffled_vector(5000)) statuses.push_back(std::to_string(n % 7 * 100));
+			auto expected = statuses;
+			std::sort(std::begin(expected), std::end(expected));
+			sort_collection::sort<sort_collection::three_way_quick_sort>(statuses);
+			Assert::IsTrue(statuses == expected);
+
+			//全て同じ値
+			std::vector<int> same(1000, 42);
+			sort_collection::sort<sort_collection::three_way_quick_sort>(same);
+			Assert::IsTrue(std::all_of(std::begin(same), std::end(same), [](int v) { return v == 42; }));
+		}
+
+		TEST_METHOD(string_sort_test)
+		{
+			//共通の接頭辞が長い文字列と、'\0'を含む文字列
+			std::mt19937 engine{ 24 };
+			std::vector<std::string> strings;
+			for (auto n : create_shuffled_vector(1000)) strings.push_back(std::string(n % 3 * 10, 'p') + std::to_string(n % 300));
+			for (int i = 0; i < 200; ++i) strings.push_back(std::string(engine() % 12, char(engine() % 2)));
+			std::shuffle(std::begin(strings), std::end(strings), engine);
+
+			auto expected = strings;
+			std::sort(std::begin(expected), std::end(expected));
+			auto ascending = strings;
+			sort_collection::sort<sort_collection::string_sort>(ascending);
+			Assert::IsTrue(ascending == expected);
+
+			std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+			auto descending = strings;
+			sort_collection::sort<sort_collection::string_sort>(descending, std::greater<>{});
+			Assert::IsTrue(descending == expected);
+
+			//射影したキーで安定にソート
+			std::vector<std::pair<std::string, int>> records;
+			for (auto n : create_shuffled_vector(1000)) records.emplace_back(std::to_string(n % 37), n);
+			auto stable_expected = records;
+			std::stable_sort(std::begin(stable_expected), std::end(stable_expected), [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; });
+
+			sort_collection::string_sort::sort(std::begin(records), std::end(records), std::less<>{}, [](const auto& record) -> const std::string& { return record.first; });
+			Assert::IsTrue(records == stable_expected);
+
+			//std::string_viewの範囲
+			std::vector<std::string_view> views(std::begin(strings), std::end(strings));
+			sort_collection::sort<sort_collection::string_sort>(views);
+			Assert::IsTrue(std::is_sorted(std::begin(views), std::end(views)));
+		}
+
+		TEST_METHOD(parallel_marge_sort_test)
+		{
+			auto array = create_shuffled_vector(100000);
+
+			//小さい閾値でタスク分割とmerge pathによる分割マージを通す
+			auto cutoff = std::exchange(sort_collection::marge_sort::parallel_cutoff, 1000);
+
+			sort_collection::sort<sort_collection::marge_sort>(std::execution::par, array);
+
+			sort_collection::marge_sort::parallel_cutoff = cutoff;
+
+			check_array<100000>(array);
+
+			//並列版を持たないアルゴリズムは逐次実行される
+			auto array2 = create_shuffled_vector(1000);
+
+			sort_collection::sort<sort_collection::shell_sort>(std::execution::par, std::begin(array2), std::end(array2));
+
+			check_array<1000>(array2);
+		}
+
+		TEST_METHOD(parallel_sample_radix_sort_test)
+		{
+			//小さい閾値でブロック分割とバケットへの分配を通す
+			auto sample_cutoff = std::exchange(sort_collection::sample_sort<>::parallel_cutoff, 1000);
+			auto stable_sample_cutoff = std::exchange(sort_collection::sample_sort<sort_collection::marge_sort>::parallel_cutoff, 1000);
+			auto radix_cutoff = std::exchange(sort_collection::radix_sort::parallel_cutoff, 1000);
+
+			auto array = create_shuffled_vector(100000);
+			sort_collection::sort<sort_collection::sample_sort<>>(std::execution::par, array);
+			check_array<100000>(array);
+
+			auto array2 = create_shuffled_vector(100000);
+			sort_collection::sort<sort_collection::radix_sort>(std::execution::par, array2);
+			check_array<100000>(array2);
+
+			//重複の多い入力と、負の値・降順
+			std::vector<int> duplicates(50000);
+			for (std::size_t i = 0; i < duplicates.size(); ++i) duplicates[i] = int(i * 7919 % 5) - 2;
+			auto expected = duplicates;
+			std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+			auto duplicates2 = duplicates;
+			sort_collection::sample_sort<>::sort(std::execution::par, std::begin(duplicates), std::end(duplicates), std::greater<int>{});
+			sort_collection::radix_sort::sort(std::execution::par, std::begin(duplicates2), std::end(duplicates2), std::greater<int>{});
+			Assert::IsTrue(duplicates == expected);
+			Assert::IsTrue(duplicates2 == expected);
+
+			//安定なアルゴリズムと組み合わせれば全体も安定
+			std::vector<std::pair<int, int>> pairs(50000);
+			for (std::size_t i = 0; i < pairs.size(); ++i) pairs[i] = { int(i * 7919 % 100), int(i) };
+			auto pairs2 = pairs;
+			sort_collection::sample_sort<sort_collection::marge_sort>::sort(std::execution::par, std::begin(pairs), std::end(pairs), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+			sort_collection::radix_sort::sort(std::execution::par, std::begin(pairs2), std::end(pairs2), std::less<>{}, [](const auto& p) { return p.first; });
+			Assert::IsTrue(std::is_sorted(std::begin(pairs), std::end(pairs)));
+			Assert::IsTrue(pairs == pairs2);
+
+			sort_collection::sample_sort<>::parallel_cutoff = sample_cutoff;
+			sort_collection::sample_sort<sort_collection::marge_sort>::parallel_cutoff = stable_sample_cutoff;
+			sort_collection::radix_sort::parallel_cutoff = radix_cutoff;
+		}
+
+		TEST_METHOD(simd_kernel_test)
+		{
+			std::mt19937 rand{ 1 };
+
+			//ソーティングネットワークで扱う大きさの前後と、番兵と同じ値を含む範囲
+			for (int size = 0; size <= 40; ++size) {
+				std::vector<std::int32_t> ints(size);
+				for (auto& n : ints) n = std::int32_t(rand() % 16) - 8;
+				ints.push_back((std::numeric_limits<std::int32_t>::max)());
+				ints.push_back((std::numeric_limits<std::int32_t>::min)());
+
+				auto expected = ints;
+				std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+				sort_collection::marge_sort::sort(std::begin(ints), std::end(ints), std::greater<>{});
+				Assert::IsTrue(ints == expected);
+
+				std::vector<std::uint32_t> uints(size);
+				for (auto& n : uints) n = std::uint32_t(rand());
+
+				auto expected_uints = uints;
+				std::sort(std::begin(expected_uints), std::end(expected_uints));
+				sort_collection::marge_sort::sort(std::begin(uints), std::end(uints), std::less<>{});
+				Assert::IsTrue(uints == expected_uints);
+
+				std::vector<float> reals(size);
+				for (auto& x : reals) x = float(rand() % 100) * 0.5f - 25.0f;
+				reals.push_back(std::numeric_limits<float>::infinity());
+
+				auto expected_reals = reals;
+				std::sort(std::begin(expected_reals), std::end(expected_reals));
+				sort_collection::pdq_sort::sort(std::begin(reals), std::end(reals), std::less<>{});
+				Assert::IsTrue(reals == expected_reals);
+			}
+		}
+
+		TEST_METHOD(auto_sort_test)
+		{
+			static std::vector<std::string> chosen;
+			auto previous = sort_collection::set_auto_sort_hook([](const sort_collection::auto_sort_decision& decision) { chosen.emplace_back(decision.algorithm); });
+
+			auto array = create_shuffled_vector(1000);
+			sort_collection::sort<sort_collection::auto_sort>(array);
+			check_array<1000>(array);
+
+			//整列済み
+			sort_collection::sort<sort_collection::auto_sort>(array);
+			check_array<1000>(array);
+
+			//狭義の逆順
+			std::reverse(std::begin(array), std::end(array));
+			sort_collection::sort<sort_collection::stable_auto_sort>(array);
+			check_array<1000>(array);
+
+			//比較ファンクタを指定した安定ソート
+			std::vector<std::pair<int, int>> records;
+			for (auto n : create_shuffled_vector(1000)) records.emplace_back(n % 10, n);
+			auto expected = records;
+			auto by_first = [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; };
+			std::stable_sort(std::begin(expected), std::end(expected), by_first);
+			sort_collection::sort<sort_collection::stable_auto_sort>(records, by_first);
+			Assert::IsTrue(records == expected);
+
+			//自明にコピーできない大きな要素は添字をソートしてから動かす
+			struct heavy {
+				int key;
+				int order;
+				std::string name;
+				std::array<int, 16> payload;
+			};
+			std::vector<heavy> heavies;
+			for (auto n : create_shuffled_vector(1000)) heavies.push_back({ n % 10, n, std::to_string(n), {} });
+			auto expected_heavies = heavies;
+			auto by_key = [](const heavy& lhs, const heavy& rhs) { return lhs.key < rhs.key; };
+			std::stable_sort(std::begin(expected_heavies), std::end(expected_heavies), by_key);
+			sort_collection::sort<sort_collection::stable_auto_sort>(heavies, by_key);
+			Assert::IsTrue(std::equal(std::begin(heavies), std::end(heavies), std::begin(expected_heavies), [](const heavy& lhs, const heavy& rhs) { return lhs.order == rhs.order && lhs.name == rhs.name; }));
+
+			//双方向・前方イテレータ
+			auto shuffled = create_shuffled_vector(100);
+			std::list<int> list(std::begin(shuffled), std::end(shuffled));
+			sort_collection::sort<sort_collection::auto_sort>(list);
+			check_array<100>(list);
+
+			std::forward_list<int> forward_list(std::begin(shuffled), std::end(shuffled));
+			sort_collection::sort<sort_collection::auto_sort>(forward_list);
+			check_array<100>(forward_list);
+
+			std::list<int> small_list(std::begin(shuffled), std::begin(shuffled) + 10);
+			sort_collection::sort<sort_collection::auto_sort>(small_list);
+			Assert::IsTrue(std::is_sorted(std::begin(small_list), std::end(small_list)));
+
+			//大きい算術型の範囲
+			auto large = create_shuffled_vector(10000);
+			sort_collection::sort<sort_collection::auto_sort>(large);
+			check_array<10000>(large);
+
+			//基数ソートでも、等しい-0.0と+0.0は入力の順のまま
+			std::vector<double> reals;
+			std::mt19937 engine{ 9 };
+			for (int i = 0; i < 5000; ++i) reals.push_back(engine() % 3 == 0 ? (engine() % 2 ? -0.0 : 0.0) : double(int(engine() % 100) - 50));
+			auto stable_reals = reals;
+			std::stable_sort(std::begin(stable_reals), std::end(stable_reals));
+			sort_collection::sort<sort_collection::stable_auto_sort>(reals);
+			Assert::IsTrue(std::equal(std::begin(reals), std::end(reals), std::begin(stable_reals), [](double lhs, double rhs) { return lhs == rhs && std::signbit(lhs) == std::signbit(rhs); }));
+
+			//文字列の範囲
+			std::vector<std::string> strings;
+			for (auto n : create_shuffled_vector(1000)) strings.push_back("item/" + std::to_string(n));
+			sort_collection::sort<sort_collection::stable_auto_sort>(strings);
+			Assert::IsTrue(std::is_sorted(std::begin(strings), std::end(strings)));
+
+			sort_collection::set_auto_sort_hook(previous);
+
+			const std::vector<std::string> expected_choices = { "pdq_sort", "none", "reverse", "marge_sort", "indirect_sort", "marge_sort", "marge_sort", "marge_sort", "marge_sort", "radix_sort", "radix_sort", "string_sort" };
+			Assert::IsTrue(chosen == expected_choices);
+		}
+
+		TEST_METHOD(instrumentation_test)
+		{
+			namespace instrumentation = sort_collection::instrumentation;
+
+			//逆順の列はバブルソートで全ての組が1度ずつ交換される
+			std::vector<int> reversed(100);
+			std::iota(std::rbegin(reversed), std::rend(reversed), 1);
+
+			auto bubble = instrumentation::count_operations<sort_collection::bubble_sort>(std::begin(reversed), std::end(reversed));
+			check_array<100>(reversed);
+			Assert::IsTrue(bubble.swaps == 100 * 99 / 2);
+			Assert::IsTrue(bubble.swaps <= bubble.comparisons);
+			Assert::IsTrue(bubble.moves == 0 && bubble.copies == 0);
+
+			auto array = create_shuffled_vector(1000);
+			auto marge = instrumentation::count_operations<sort_collection::marge_sort>(std::begin(array), std::end(array), std::less<>{});
+			check_array<1000>(array);
+			Assert::IsTrue(0 < marge.comparisons && marge.comparisons <= 1000 * 10);
+			Assert::IsTrue(0 < marge.moves && marge.copies == 0);
+
+			//基数ソートは比較しない
+			array = create_shuffled_vector(1000);
+			auto radix = instrumentation::count_operations<sort_collection::radix_sort>(std::begin(array), std::end(array));
+			check_array<1000>(array);
+			Assert::IsTrue(radix.comparisons == 0 && 0 < radix.moves);
+
+#if defined(SORT_COLLECTION_INSTRUMENTATION)
+			Assert::IsTrue(500 * sizeof(instrumentation::counted<int>) <= marge.workspace_bytes);
+			Assert::IsTrue(10 <= marge.max_recursion_depth && marge.max_recursion_depth <= 12);
+#endif
+
+			//包んだ比較ファンクタだけでも数えられる
+			array = create_shuffled_vector(1000);
+			{
+				instrumentation::scope measuring{};
+				sort_collection::sort<sort_collection::pdq_sort>(array, instrumentation::counted_compare{ std::less<>{} });
+				Assert::IsTrue(1000 <= measuring.counts().comparisons);
+			}
+			check_array<1000>(array);
+		}
+
+		TEST_METHOD(external_sort_test)
+		{
+			struct record {
+				std::int32_t key;
+				std::int32_t index;
+			};
+
+			const auto directory = std::filesystem::temp_directory_path();
+			const auto input = directory / "sort_collection_external_sort_test.in";
+			const auto output = directory / "sort_collection_external_sort_test.out";
+
+			//キーの重複が多いレコードを書き出す
+			std::vector<record> records;
+			{
+				auto keys = create_shuffled_vector(100000);
+				for (std::int32_t i = 0; i < std::int32_t(keys.size()); ++i) records.push_back({ keys[i] % 1000, i });
+
+				std::ofstream out{ input, std::ios::binary };
+				out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(record));
+			}
+
+			//メモリを絞って、多数のランと複数回のマージを通す
+			sort_collection::external_sort_options options{};
+			options.memory_budget = 64 * 1024;
+			options.io_buffer_size = 4 * 1024;
+
+			auto by_key = [](const record& lhs, const record& rhs) { return lhs.key < rhs.key; };
+			sort_collection::external_sort<sort_collection::marge_sort, record>(input, output, by_key, options);
+
+			std::vector<record> sorted(records.size());
+			{
+				std::ifstream in{ output, std::ios::binary };
+				in.read(reinterpret_cast<char*>(sorted.data()), sorted.size() * sizeof(record));
+				Assert::IsTrue(std::size_t(in.gcount()) == sorted.size() * sizeof(record));
+				Assert::IsTrue(in.peek() == std::ifstream::traits_type::eof());
+			}
+
+			//安定なアルゴリズムでランを作れば全体も安定になる
+			std::stable_sort(std::begin(records), std::end(records), by_key);
+			Assert::IsTrue(std::equal(std::begin(records), std::end(records), std::begin(sorted), [](const record& lhs, const record& rhs) { return lhs.key == rhs.key && lhs.index == rhs.index; }));
+
+			//空のファイル
+			std::ofstream{ input, std::ios::binary | std::ios::trunc };
+			sort_collection::external_sort<sort_collection::pdq_sort, int>(input, output);
+			Assert::IsTrue(std::filesystem::file_size(output) == 0);
+
+			std::filesystem::remove(input);
+			std::filesystem::remove(output);
+		}
 	};
 }
\ No newline at end of file
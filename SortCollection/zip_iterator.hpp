@@ -0,0 +1,273 @@
+﻿#pragma once
+
+#include "sort.hpp"
+
+#include <tuple>
+
+namespace sort_collection {
+
+	/**
+	* @brief 複数の列の同じ位置の要素をまとめて指す参照（プロキシ）
+	* @detail 代入・swapは全ての列へ同時に行われるので、列ごとに分かれたデータ（SoA）をそのまま並べ替えられる
+	* @detail 値（value_type = std::tuple）への変換とプロキシ同士の代入はコピーになる。一時オブジェクトのtupleからの代入はムーブする
+	* @tparam References 各列のイテレータの参照型
+	*/
+	template<typename... References>
+	class zip_reference {
+	public:
+		using value_type = std::tuple<std::remove_cv_t<std::remove_reference_t<References>>...>;
+
+		explicit zip_reference(References... refs) : m_refs(std::forward<References>(refs)...) {}
+
+		zip_reference(const zip_reference&) = default;
+
+		/**
+		* @brief 参照先へ代入する（参照を付け替えるのではない）
+		*/
+		auto operator=(const zip_reference& other) -> zip_reference& {
+			assign(other.m_refs, std::index_sequence_for<References...>{});
+			return *this;
+		}
+
+		auto operator=(const value_type& value) -> zip_reference& {
+			assign(value, std::index_sequence_for<References...>{});
+			return *this;
+		}
+
+		auto operator=(value_type&& value) -> zip_reference& {
+			assign(std::move(value), std::index_sequence_for<References...>{});
+			return *this;
+		}
+
+		operator value_type() const {
+			return std::apply([](const auto&... refs) { return value_type(refs...); }, m_refs);
+		}
+
+		/**
+		* @brief I番目の列の要素
+		*/
+		template<std::size_t I>
+		auto get() const -> std::tuple_element_t<I, std::tuple<References...>> {
+			return std::get<I>(m_refs);
+		}
+
+		/**
+		* @brief 全ての列の要素を入れ替える
+		*/
+		friend void swap(zip_reference lhs, zip_reference rhs) {
+			lhs.swap_with(rhs, std::index_sequence_for<References...>{});
+		}
+
+	private:
+
+		template<typename Tuple, std::size_t... I>
+		void assign(Tuple&& values, std::index_sequence<I...>) {
+			((std::get<I>(m_refs) = std::get<I>(std::forward<Tuple>(values))), ...);
+		}
+
+		template<std::size_t... I>
+		void swap_with(zip_reference& other, std::index_sequence<I...>) {
+			using std::swap;
+			(swap(std::get<I>(m_refs), std::get<I>(other.m_refs)), ...);
+		}
+
+		std::tuple<References...> m_refs;
+	};
+
+	/**
+	* @brief zip_referenceのI番目の列の要素を取り出す
+	*/
+	template<std::size_t I, typename... References>
+	auto get(const zip_reference<References...>& ref) -> std::tuple_element_t<I, std::tuple<References...>> {
+		return ref.template get<I>();
+	}
+
+	/**
+	* @brief 複数の列のイテレータを束ねて1つの列として扱うイテレータ
+	* @detail 進める・比べる操作は全ての列に対して行う。イテレータカテゴリは各列の内で最も弱いものになる
+	* @tparam Iterators 各列のイテレータ
+	*/
+	template<typename... Iterators>
+	class zip_iterator {
+		static_assert(0 < sizeof...(Iterators), "zip_iterator requires at least one iterator.");
+
+		//先頭の列のイテレータ（比較と距離の計算に使う）
+		using first_iterator = std::tuple_element_t<0, std::tuple<Iterators...>>;
+
+	public:
+		using iterator_category = std::common_type_t<typename std::iterator_traits<Iterators>::iterator_category...>;
+		using value_type = std::tuple<typename std::iterator_traits<Iterators>::value_type...>;
+		using difference_type = std::common_type_t<typename std::iterator_traits<Iterators>::difference_type...>;
+		using reference = zip_reference<typename std::iterator_traits<Iterators>::reference...>;
+		using pointer = void;
+
+		zip_iterator() = default;
+
+		explicit zip_iterator(Iterators... its) : m_its(its...) {}
+
+		auto operator*() const -> reference {
+			return std::apply([](const auto&... its) { return reference(*its...); }, m_its);
+		}
+
+		auto operator[](difference_type n) const -> reference {
+			return *(*this + n);
+		}
+
+		auto operator++() -> zip_iterator& {
+			std::apply([](auto&... its) { (++its, ...); }, m_its);
+			return *this;
+		}
+
+		auto operator++(int) -> zip_iterator {
+			auto copy = *this;
+			++*this;
+			return copy;
+		}
+
+		auto operator--() -> zip_iterator& {
+			std::apply([](auto&... its) { (--its, ...); }, m_its);
+			return *this;
+		}
+
+		auto operator--(int) -> zip_iterator {
+			auto copy = *this;
+			--*this;
+			return copy;
+		}
+
+		auto operator+=(difference_type n) -> zip_iterator& {
+			std::apply([n](auto&... its) { ((its += n), ...); }, m_its);
+			return *this;
+		}
+
+		auto operator-=(difference_type n) -> zip_iterator& {
+			return *this += -n;
+		}
+
+		friend auto operator+(zip_iterator it, difference_type n) -> zip_iterator {
+			return it += n;
+		}
+
+		friend auto operator+(difference_type n, zip_iterator it) -> zip_iterator {
+			return it += n;
+		}
+
+		friend auto operator-(zip_iterator it, difference_type n) -> zip_iterator {
+			return it -= n;
+		}
+
+		friend auto operator-(const zip_iterator& lhs, const zip_iterator& rhs) -> difference_type {
+			return difference_type(lhs.first() - rhs.first());
+		}
+
+		friend bool operator==(const zip_iterator& lhs, const zip_iterator& rhs) {
+			return lhs.first() == rhs.first();
+		}
+
+		friend bool operator!=(const zip_iterator& lhs, const zip_iterator& rhs) {
+			return !(lhs == rhs);
+		}
+
+		friend bool operator<(const zip_iterator& lhs, const zip_iterator& rhs) {
+			return lhs.first() < rhs.first();
+		}
+
+		friend bool operator>(const zip_iterator& lhs, const zip_iterator& rhs) {
+			return rhs < lhs;
+		}
+
+		friend bool operator<=(const zip_iterator& lhs, const zip_iterator& rhs) {
+			return !(rhs < lhs);
+		}
+
+		friend bool operator>=(const zip_iterator& lhs, const zip_iterator& rhs) {
+			return !(lhs < rhs);
+		}
+
+		/**
+		* @brief 束ねている各列のイテレータ
+		*/
+		auto base() const -> const std::tuple<Iterators...>& {
+			return m_its;
+		}
+
+	private:
+
+		auto first() const -> const first_iterator& {
+			return std::get<0>(m_its);
+		}
+
+		std::tuple<Iterators...> m_its;
+	};
+
+	/**
+	* @brief 各列のイテレータからzip_iteratorを作る
+	*/
+	template<typename... Iterators>
+	auto make_zip_iterator(Iterators... its) -> zip_iterator<Iterators...> {
+		return zip_iterator<Iterators...>(its...);
+	}
+
+	/**
+	* @brief 複数のコンテナを束ねた範囲
+	* @detail 長さは先頭のコンテナに合わせる（残りのコンテナはそれ以上の長さであること）
+	*/
+	template<typename... Containers>
+	class zip_range {
+		using iterator = zip_iterator<decltype(std::begin(std::declval<Containers&>()))...>;
+
+	public:
+
+		explicit zip_range(Containers&... containers) : m_containers(containers...) {}
+
+		auto begin() const -> iterator {
+			return std::apply([](auto&... containers) { return iterator(std::begin(containers)...); }, m_containers);
+		}
+
+		auto end() const -> iterator {
+			const auto N = std::distance(std::begin(std::get<0>(m_containers)), std::end(std::get<0>(m_containers)));
+			return std::apply([N](auto&... containers) { return iterator(std::next(std::begin(containers), N)...); }, m_containers);
+		}
+
+	private:
+		std::tuple<Containers&...> m_containers;
+	};
+
+	/**
+	* @brief 複数のコンテナを列として束ねる
+	* @code
+	* auto columns = sort_collection::zip(keys, payloads);
+	* sort_collection::sort<sort_collection::pdq_sort>(columns, sort_collection::by_column<0>());
+	* @endcode
+	*/
+	template<typename... Containers>
+	auto zip(Containers&... containers) -> zip_range<Containers...> {
+		return zip_range<Containers...>(containers...);
+	}
+
+	/**
+	* @brief I番目の列だけを比較するファンクタ
+	* @detail zip_referenceと、そのvalue_typeであるstd::tupleのどちらの組み合わせでも比較できる
+	* @tparam I 比較する列
+	* @tparam Compare 列の要素の比較に使うファンクタ
+	*/
+	template<std::size_t I, typename Compare = std::less<>>
+	struct column_compare {
+		Compare comp{};
+
+		template<typename L, typename R>
+		constexpr bool operator()(const L& lhs, const R& rhs) const {
+			using std::get;
+			return comp(get<I>(lhs), get<I>(rhs));
+		}
+	};
+
+	/**
+	* @brief I番目の列をキーにして比較するファンクタを作る
+	* @param comp 列の要素の比較に使うファンクタ
+	*/
+	template<std::size_t I, typename Compare = std::less<>>
+	constexpr auto by_column(Compare comp = Compare{}) -> column_compare<I, Compare> {
+		return column_compare<I, Compare>{ std::move(comp) };
+	}
+}